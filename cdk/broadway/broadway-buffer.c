@@ -38,11 +38,16 @@ struct entry {
 struct _BroadwayBuffer {
   guint8 *data;
   struct entry *table;
+  guint32 *grid_hashes;  /* hash of the block at each grid point */
+  guint8 *damage;        /* per block, NULL if everything changed */
   int width, height, stride;
   int encoded;
-  int block_stride, length, block_count, shift;
+  int block_stride, block_rows, length, block_count, shift;
   int stats[5];
   int clashes;
+  int matches;
+  int bytes;
+  int damaged_blocks;
 };
 
 static const guint32 prime = 0x1f821e2d;
@@ -57,9 +62,14 @@ static const guint32 end_vprime = 0xcdb99001;	/* vprime^block_size */
 static const guint32 step = 0x0ac93019;
 static const int block_size = 32, block_mask = 31;
 
+/* Bands smaller than this are not worth handing to another thread */
+#define MIN_BAND_ROWS 128
+#define MIN_PARALLEL_PIXELS (512 * 512)
+
 static gboolean
 verify_block_match (BroadwayBuffer *buffer, int x, int y,
-                    BroadwayBuffer *prev, struct entry *entry)
+                    BroadwayBuffer *prev, struct entry *entry,
+                    int *clashes)
 {
   int i;
   int w1, w2, h1, h2;
@@ -91,7 +101,7 @@ verify_block_match (BroadwayBuffer *buffer, int x, int y,
       old = prev->data + (entry->y + i) * prev->stride + entry->x * 4;
       if (memcmp (match, old, w1 * 4) != 0)
         {
-          buffer->clashes++;
+          (*clashes)++;
           return FALSE;
         }
     }
@@ -147,6 +157,7 @@ struct encoder {
   guint32 color_run;
   guint32 delta;
   guint32 delta_run;
+  int skip;
   GString *dest;
   int bytes;
 };
@@ -203,12 +214,55 @@ encode_run (struct encoder *encoder)
     }
 }
 
+/* Pixels outside the damage are known to be unchanged, so they are
+ * only counted here and emitted as delta 0 runs once the next encoded
+ * pixel needs them for positioning.
+ */
+static void
+encode_skip (struct encoder *encoder, int n_pixels)
+{
+  if (n_pixels <= 0)
+    return;
+
+  /* A pending delta 0 run is the same thing, so fold it in */
+  if (encoder->skip == 0 &&
+      encoder->delta == 0 &&
+      encoder->delta_run > encoder->color_run)
+    {
+      encoder->skip = encoder->delta_run;
+      encoder->color_run = 0;
+      encoder->delta_run = 0;
+    }
+
+  encoder->skip += n_pixels;
+}
+
+static void
+flush_skip (struct encoder *encoder)
+{
+  guint32 len;
+
+  encode_run (encoder);
+  encoder->color_run = 0;
+  encoder->delta_run = 0;
+
+  while (encoder->skip > 0)
+    {
+      len = MIN (encoder->skip, 0xFFFFF);
+      emit (encoder, 0x00100000 | len);
+      encoder->skip -= len;
+    }
+}
+
 static void
 encode_pixel (struct encoder *encoder, guint32 color, guint32 prev_color)
 {
   guint32 delta = 0;
   guint32 a, r, g, b;
 
+  if (G_UNLIKELY (encoder->skip > 0))
+    flush_skip (encoder);
+
   if (color == prev_color)
     delta = 0;
   else if (prev_color == 0)
@@ -284,6 +338,8 @@ broadway_buffer_destroy (BroadwayBuffer *buffer)
 {
   g_free (buffer->data);
   g_free (buffer->table);
+  g_free (buffer->grid_hashes);
+  g_free (buffer->damage);
   g_free (buffer);
 }
 
@@ -299,6 +355,18 @@ broadway_buffer_get_height (BroadwayBuffer *buffer)
   return buffer->height;
 }
 
+void
+broadway_buffer_get_stats (BroadwayBuffer      *buffer,
+                           BroadwayBufferStats *stats)
+{
+  memcpy (stats->collisions, buffer->stats, sizeof stats->collisions);
+  stats->clashes = buffer->clashes;
+  stats->matches = buffer->matches;
+  stats->blocks = buffer->block_count;
+  stats->damaged_blocks = buffer->damaged_blocks;
+  stats->bytes = buffer->bytes;
+}
+
 static void
 unpremultiply_line (void *destp, void *srcp, int width)
 {
@@ -328,11 +396,43 @@ unpremultiply_line (void *destp, void *srcp, int width)
     }
 }
 
-BroadwayBuffer *
-broadway_buffer_create (int width, int height, guint8 *data, int stride)
+static void
+mark_damage (BroadwayBuffer *buffer, cairo_region_t *damage)
+{
+  cairo_rectangle_int_t rect;
+  int i, n_rects, bx, by, bx0, bx1, by0, by1;
+
+  n_rects = cairo_region_num_rectangles (damage);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_region_get_rectangle (damage, i, &rect);
+
+      bx0 = MAX (rect.x, 0) / block_size;
+      by0 = MAX (rect.y, 0) / block_size;
+      bx1 = (MIN (rect.x + rect.width, buffer->width) + block_mask) / block_size;
+      by1 = (MIN (rect.y + rect.height, buffer->height) + block_mask) / block_size;
+
+      for (by = by0; by < by1; by++)
+        for (bx = bx0; bx < bx1; bx++)
+          buffer->damage[by * buffer->block_stride + bx] = TRUE;
+    }
+
+  buffer->damaged_blocks = 0;
+  for (i = 0; i < buffer->block_count; i++)
+    if (buffer->damage[i])
+      buffer->damaged_blocks++;
+}
+
+/* Creates a buffer from premultiplied ARGB data. If @damage is given,
+ * only the pixels inside it are taken from @data, the rest is copied
+ * from @prev, which must have the same size. The damage is remembered,
+ * so that encoding against @prev only has to look at the damaged blocks.
+ */
+static BroadwayBuffer *
+buffer_new (int width, int height)
 {
   BroadwayBuffer *buffer;
-  int y, bits_required;
+  int bits_required;
 
   buffer = g_new0 (BroadwayBuffer, 1);
   buffer->width = width;
@@ -340,28 +440,164 @@ broadway_buffer_create (int width, int height, guint8 *data, int stride)
   buffer->height = height;
 
   buffer->block_stride = (width + block_size - 1) / block_size;
-  buffer->block_count =
-    buffer->block_stride * ((height + block_size - 1) / block_size);
+  buffer->block_rows = (height + block_size - 1) / block_size;
+  buffer->block_count = buffer->block_stride * buffer->block_rows;
   bits_required = g_bit_storage (buffer->block_count * 4);
   buffer->shift = 32 - bits_required;
   buffer->length = 1 << bits_required;
 
   buffer->table = g_malloc0 (buffer->length * sizeof buffer->table[0]);
+  buffer->grid_hashes = g_new0 (guint32, buffer->block_count);
 
   memset (buffer->stats, 0, sizeof buffer->stats);
   buffer->clashes = 0;
+  buffer->damaged_blocks = buffer->block_count;
 
   buffer->data = g_malloc (buffer->stride * height);
 
+  return buffer;
+}
+
+BroadwayBuffer *
+broadway_buffer_create (int width, int height, guint8 *data, int stride,
+                        BroadwayBuffer *prev, cairo_region_t *damage)
+{
+  BroadwayBuffer *buffer;
+  int x, y, x1, bx, by;
+  guint8 *dest, *src;
+
+  buffer = buffer_new (width, height);
+
+  if (prev == NULL || damage == NULL ||
+      prev->width != width || prev->height != height)
+    {
+      for (y = 0; y < height; y++)
+        unpremultiply_line (buffer->data + y * buffer->stride, data + y * stride, width);
+
+      return buffer;
+    }
+
+  buffer->damage = g_malloc0 (buffer->block_count);
+  mark_damage (buffer, damage);
+
   for (y = 0; y < height; y++)
-    unpremultiply_line (buffer->data + y * buffer->stride, data + y * stride, width);
+    {
+      by = y / block_size;
+      dest = buffer->data + y * buffer->stride;
+      src = data + y * stride;
+
+      for (bx = 0; bx < buffer->block_stride; )
+        {
+          gboolean damaged = buffer->damage[by * buffer->block_stride + bx];
+
+          x = bx * block_size;
+          while (bx < buffer->block_stride &&
+                 buffer->damage[by * buffer->block_stride + bx] == damaged)
+            bx++;
+          x1 = MIN (bx * block_size, width);
+
+          if (damaged)
+            unpremultiply_line (dest + x * 4, src + x * 4, x1 - x);
+          else
+            memcpy (dest + x * 4, prev->data + y * prev->stride + x * 4, (x1 - x) * 4);
+        }
+    }
 
   return buffer;
 }
 
-void
-broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *dest)
+struct encode_sync {
+  GMutex mutex;
+  GCond cond;
+  int pending;
+};
+
+/* Returns a lossy copy of @buffer for slow links, scaled down by
+ * @scale in both directions and with only the top @color_bits bits
+ * of each color channel. It is meant to be encoded as a keyframe and
+ * replaced by the real contents later.
+ */
+BroadwayBuffer *
+broadway_buffer_create_reduced (BroadwayBuffer *buffer,
+                                int             scale,
+                                int             color_bits)
 {
+  BroadwayBuffer *reduced;
+  guint32 *line, *dest, pixel, mask, bias;
+  guint32 sum[4];
+  int x, y, i, j, n, c, width, height;
+
+  width = (buffer->width + scale - 1) / scale;
+  height = (buffer->height + scale - 1) / scale;
+  reduced = buffer_new (width, height);
+
+  mask = (0xff << (8 - color_bits)) & 0xff;
+  bias = (0x80 >> color_bits) & ~mask;
+
+  for (y = 0; y < height; y++)
+    {
+      dest = (guint32 *) (reduced->data + y * reduced->stride);
+
+      for (x = 0; x < width; x++)
+        {
+          memset (sum, 0, sizeof sum);
+          n = 0;
+
+          for (i = y * scale; i < MIN ((y + 1) * scale, buffer->height); i++)
+            {
+              line = (guint32 *) (buffer->data + i * buffer->stride);
+              for (j = x * scale; j < MIN ((x + 1) * scale, buffer->width); j++)
+                {
+                  for (c = 0; c < 4; c++)
+                    sum[c] += (line[j] >> (c * 8)) & 0xff;
+                  n++;
+                }
+            }
+
+          pixel = 0;
+          for (c = 0; c < 4; c++)
+            {
+              guint32 v = (sum[c] + n / 2) / n;
+
+              /* Leave alpha alone, colors lose their low bits */
+              if (c < 3)
+                v = (v & mask) | bias;
+              pixel |= v << (c * 8);
+            }
+
+          /* Fully transparent pixels have to be 0, see the encoding */
+          if ((pixel & 0xff000000) == 0)
+            pixel = 0;
+
+          dest[x] = pixel;
+        }
+    }
+
+  return reduced;
+}
+
+/* A horizontal band of the buffer, encoded on its own into @dest. Only
+ * the columns from @x0 to @x1 are looked at, the rest of each row is
+ * skipped. Block matches are not allowed to reach below @match_limit,
+ * since the rows there belong to a band that is encoded separately.
+ */
+struct encode_job {
+  BroadwayBuffer *buffer;
+  BroadwayBuffer *prev;
+  int x0, x1, y0, y1;
+  int match_limit;
+  GString *dest;
+  int trailing_skip;
+  int clashes;
+  int matches;
+  struct encode_sync *sync;
+};
+
+static void
+encode_job_run (struct encode_job *job)
+{
+  BroadwayBuffer *buffer = job->buffer;
+  BroadwayBuffer *prev = job->prev;
   struct entry *entry;
   int i, j, k;
   int x0, x1, y0, y1;
@@ -370,28 +606,26 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
   int width, height;
   struct encoder encoder = { 0 };
   int *skyline, skyline_pixels;
-  int matches;
 
   width = buffer->width;
   height = buffer->height;
-  x0 = 0;
-  x1 = width;
-  y0 = 0;
-  y1 = height;
+  x0 = job->x0;
+  x1 = job->x1;
+  y0 = job->y0;
+  y1 = job->y1;
 
   skyline = g_malloc0 ((width + block_size) * sizeof skyline[0]);
 
   block_hashes = g_malloc0 (width * sizeof block_hashes[0]);
 
-  matches = 0;
-  encoder.dest = dest;
+  encoder.dest = job->dest;
 
   // Calculate the block hashes for the first row
-  for (i = y0; i < MIN(y1, y0 + block_size); i++)
+  for (i = y0; i < MIN(height, y0 + block_size); i++)
     {
       line = (guint32 *)(buffer->data + i * buffer->stride);
       hash = 0;
-      for (j = x0; j < MIN(x1, x0 + block_size); j++)
+      for (j = x0; j < MIN(width, x0 + block_size); j++)
         hash = hash * prime + line[j];
       for (; j < x0 + block_size; j++)
         hash = hash * prime;
@@ -425,6 +659,8 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
       else
         prev_line = NULL;
 
+      encode_skip (&encoder, x0);
+
       for (j = x0; j < x0 + block_size; j++)
         {
           hash = hash * prime;
@@ -455,10 +691,11 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
               entry = lookup_block (prev, h);
               if (entry && entry->count < 2 &&
                   skyline_pixels >= block_size &&
-                  verify_block_match (buffer, j, i, prev, entry) &&
+                  MIN (i + block_size, height) <= job->match_limit &&
+                  verify_block_match (buffer, j, i, prev, entry, &job->clashes) &&
                   (entry->x != j || entry->y != i))
                 {
-                  matches++;
+                  job->matches++;
                   encode_block (&encoder, entry, j, i);
 
                   for (k = 0; k < block_size; k++)
@@ -483,10 +720,9 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
           else
             skyline_pixels++;
 
-          /* Insert block in hash table if we're on a
-           * grid point. */
+          /* Remember the hash if we're on a grid point. */
           if (((i | j) & block_mask) == 0 && !buffer->encoded)
-            insert_block (buffer, block_hashes[j], j, i);
+            buffer->grid_hashes[(i / block_size) * buffer->block_stride + j / block_size] = block_hashes[j];
 
           /* Update sliding block hash */
           block_hashes[j] =
@@ -503,27 +739,245 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
           if  (j + block_size < width)
             hash += line[j + block_size] ;
         }
+
+      encode_skip (&encoder, width - x1);
     }
 
   encoder_flush (&encoder);
-
-#if 0
-  fprintf(stderr, "collision stats:");
-  for (i = 0; i < (int) G_N_ELEMENTS(buffer->stats); i++)
-    fprintf(stderr, "%c%d", i == 0 ? ' ' : '/', buffer->stats[i]);
-  fprintf(stderr, "\n");
-
-  fprintf(stderr, "%d / %d blocks (%d%%) matched, %d clashes\n",
-          matches, buffer->block_count,
-          100 * matches / buffer->block_count, buffer->clashes);
-
-  fprintf(stderr, "output stream %d bytes, raw buffer %d bytes (%d%%)\n",
-          encoder.bytes, height * buffer->stride,
-          100 * encoder.bytes / (height * buffer->stride));
-#endif
+  job->trailing_skip = encoder.skip;
 
   g_free (skyline);
   g_free (block_hashes);
+}
+
+static void
+encode_job_thread (gpointer data,
+                   gpointer user_data)
+{
+  struct encode_job *job = data;
+
+  encode_job_run (job);
+
+  g_mutex_lock (&job->sync->mutex);
+  if (--job->sync->pending == 0)
+    g_cond_signal (&job->sync->cond);
+  g_mutex_unlock (&job->sync->mutex);
+}
+
+/* The calling thread encodes one band itself, so the pool has one
+ * thread less than there are processors, and none on a single core.
+ */
+static GThreadPool *
+get_encode_pool (void)
+{
+  static gsize initialized = 0;
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&initialized))
+    {
+      int n_threads;
+
+      n_threads = MIN (g_get_num_processors (), 8) - 1;
+      if (n_threads > 0)
+        pool = g_thread_pool_new (encode_job_thread, NULL, n_threads, FALSE, NULL);
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return pool;
+}
+
+/* Adds jobs for the block rows from @by0 to @by1 and the columns from
+ * @x0 to @x1, split into bands if the area is large enough to be worth
+ * encoding in parallel.
+ */
+static void
+add_jobs (GArray *jobs, BroadwayBuffer *buffer, BroadwayBuffer *prev,
+          int x0, int x1, int by0, int by1)
+{
+  GThreadPool *pool;
+  struct encode_job job = { 0 };
+  int y0, y1, n_bands, band_rows, i;
+
+  y0 = by0 * block_size;
+  y1 = MIN (by1 * block_size, buffer->height);
+
+  n_bands = 1;
+  pool = get_encode_pool ();
+  if (pool != NULL && (x1 - x0) * (y1 - y0) >= MIN_PARALLEL_PIXELS)
+    n_bands = CLAMP ((y1 - y0) / MIN_BAND_ROWS, 1,
+                     (int) g_thread_pool_get_max_threads (pool) + 1);
+
+  /* Bands start on block rows, so that the grid points fall inside them */
+  band_rows = ((by1 - by0 + n_bands - 1) / n_bands) * block_size;
+
+  for (i = y0; i < y1; i += band_rows)
+    {
+      job.buffer = buffer;
+      job.prev = prev;
+      job.x0 = x0;
+      job.x1 = x1;
+      job.y0 = i;
+      job.y1 = MIN (i + band_rows, y1);
+      /* Matches in the last band may reach into the undamaged rows below,
+       * they hold the same pixels as the verified block anyway.
+       */
+      job.match_limit = job.y1 < y1 ? job.y1 : buffer->height;
+      g_array_append_val (jobs, job);
+    }
+}
+
+void
+broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *dest)
+{
+  GArray *jobs;
+  struct encode_job *job;
+  struct encode_sync sync;
+  GThreadPool *pool;
+  struct encoder encoder = { 0 };
+  guint8 *damage;
+  int bx, by, by0, bx0, bx1, trailing;
+  guint i;
+  gsize start;
+
+  start = dest->len;
+
+  /* The damage is relative to the buffer this was created from, and
+   * undamaged blocks reuse its grid hashes, so it only helps if those
+   * exist. Otherwise everything is encoded.
+   */
+  damage = buffer->damage;
+  if (prev == NULL || !prev->encoded ||
+      prev->width != buffer->width || prev->height != buffer->height)
+    damage = NULL;
+
+  jobs = g_array_new (FALSE, TRUE, sizeof (struct encode_job));
+
+  if (damage == NULL)
+    {
+      buffer->damaged_blocks = buffer->block_count;
+      add_jobs (jobs, buffer, prev, 0, buffer->width, 0, buffer->block_rows);
+    }
+  else
+    {
+      if (!buffer->encoded)
+        memcpy (buffer->grid_hashes, prev->grid_hashes,
+                buffer->block_count * sizeof buffer->grid_hashes[0]);
+
+      /* Group consecutive damaged block rows, and encode them in the
+       * column range that has damage in any of them.
+       */
+      for (by = 0; by < buffer->block_rows; )
+        {
+          by0 = by;
+          bx0 = buffer->block_stride;
+          bx1 = 0;
+
+          for (; by < buffer->block_rows; by++)
+            {
+              gboolean damaged = FALSE;
+
+              for (bx = 0; bx < buffer->block_stride; bx++)
+                if (damage[by * buffer->block_stride + bx])
+                  {
+                    damaged = TRUE;
+                    bx0 = MIN (bx0, bx);
+                    bx1 = MAX (bx1, bx + 1);
+                  }
+
+              if (!damaged)
+                break;
+            }
+
+          if (by > by0)
+            add_jobs (jobs, buffer, prev,
+                      bx0 * block_size, MIN (bx1 * block_size, buffer->width),
+                      by0, by);
+          else
+            by++;
+        }
+    }
+
+  for (i = 0; i < jobs->len; i++)
+    {
+      job = &g_array_index (jobs, struct encode_job, i);
+      job->dest = i == 0 ? dest : g_string_new (NULL);
+      job->sync = &sync;
+    }
+
+  g_mutex_init (&sync.mutex);
+  g_cond_init (&sync.cond);
+  sync.pending = jobs->len > 0 ? jobs->len - 1 : 0;
+
+  /* The first band goes straight into dest, so the runs skipping the
+   * undamaged rows above it are written first.
+   */
+  if (jobs->len > 0)
+    {
+      job = &g_array_index (jobs, struct encode_job, 0);
+      encoder.dest = dest;
+      encode_skip (&encoder, job->y0 * buffer->width);
+      flush_skip (&encoder);
+
+      pool = get_encode_pool ();
+
+      for (i = 1; i < jobs->len; i++)
+        {
+          /* Without a pool, the other bands are encoded here as well */
+          if (pool)
+            g_thread_pool_push (pool, &g_array_index (jobs, struct encode_job, i), NULL);
+          else
+            encode_job_thread (&g_array_index (jobs, struct encode_job, i), NULL);
+        }
+
+      encode_job_run (job);
+    }
+
+  g_mutex_lock (&sync.mutex);
+  while (sync.pending > 0)
+    g_cond_wait (&sync.cond, &sync.mutex);
+  g_mutex_unlock (&sync.mutex);
+
+  g_mutex_clear (&sync.mutex);
+  g_cond_clear (&sync.cond);
+
+  buffer->matches = 0;
+  buffer->clashes = 0;
+  trailing = 0;
+  for (i = 0; i < jobs->len; i++)
+    {
+      job = &g_array_index (jobs, struct encode_job, i);
+
+      if (i > 0)
+        {
+          /* Skip what the previous band left, and the rows in between */
+          encode_skip (&encoder, trailing +
+                       (job->y0 - g_array_index (jobs, struct encode_job, i - 1).y1) * buffer->width);
+          flush_skip (&encoder);
+
+          g_string_append_len (dest, job->dest->str, job->dest->len);
+          g_string_free (job->dest, TRUE);
+        }
+
+      trailing = job->trailing_skip;
+      buffer->matches += job->matches;
+      buffer->clashes += job->clashes;
+    }
+
+  g_array_free (jobs, TRUE);
+
+  /* Undamaged blocks got their hashes from prev, the rest were filled in
+   * by the jobs, so the table can be built in grid order now.
+   */
+  if (!buffer->encoded)
+    {
+      for (by = 0; by < buffer->block_rows; by++)
+        for (bx = 0; bx < buffer->block_stride; bx++)
+          insert_block (buffer, buffer->grid_hashes[by * buffer->block_stride + bx],
+                        bx * block_size, by * block_size);
+    }
+
+  buffer->bytes = dest->len - start;
 
   buffer->encoded = TRUE;
 }
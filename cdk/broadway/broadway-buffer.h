@@ -3,18 +3,35 @@
 
 #include "broadway-protocol.h"
 #include <glib-object.h>
+#include <cairo.h>
 
 typedef struct _BroadwayBuffer BroadwayBuffer;
 
+typedef struct {
+  int collisions[5];  /* blocks inserted after 0, 1, ... probes */
+  int clashes;        /* hash matches that differed in content */
+  int matches;        /* blocks sent as references to the old frame */
+  int blocks;
+  int damaged_blocks;
+  int bytes;          /* size of the last encoding */
+} BroadwayBufferStats;
+
 BroadwayBuffer *broadway_buffer_create     (int             width,
                                             int             height,
                                             guint8         *data,
-                                            int             stride);
+                                            int             stride,
+                                            BroadwayBuffer *prev,
+                                            cairo_region_t *damage);
+BroadwayBuffer *broadway_buffer_create_reduced (BroadwayBuffer *buffer,
+                                                int             scale,
+                                                int             color_bits);
 void            broadway_buffer_destroy    (BroadwayBuffer *buffer);
 void            broadway_buffer_encode     (BroadwayBuffer *buffer,
                                             BroadwayBuffer *prev,
                                             GString        *dest);
 int             broadway_buffer_get_width  (BroadwayBuffer *buffer);
 int             broadway_buffer_get_height (BroadwayBuffer *buffer);
+void            broadway_buffer_get_stats  (BroadwayBuffer      *buffer,
+                                            BroadwayBufferStats *stats);
 
 #endif /* __BROADWAY_BUFFER__ */
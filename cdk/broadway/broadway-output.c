@@ -16,8 +16,113 @@ struct BroadwayOutput {
   GString *buf;
   int error;
   guint32 serial;
+
+  /* Frames not yet written out, so that a slow client does not block
+   * the daemon */
+  GQueue pending;
+  gsize pending_offset;
+  gsize pending_size;
+  GSource *pending_source;
+  guint64 queued_bytes;
+
+  /* Where the buffer updates are in buf, so that forwarding can leave
+   * them out */
+  GArray *buffer_ranges;
 };
 
+typedef struct {
+  gsize offset;
+  gsize length;
+  int id;
+} BufferRange;
+
+static void write_pending (BroadwayOutput *output);
+
+static gboolean
+write_pending_cb (GObject        *stream,
+                  BroadwayOutput *output)
+{
+  g_source_unref (output->pending_source);
+  output->pending_source = NULL;
+
+  write_pending (output);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+clear_pending (BroadwayOutput *output)
+{
+  g_queue_clear_full (&output->pending, (GDestroyNotify) g_bytes_unref);
+  output->pending_offset = 0;
+  output->pending_size = 0;
+}
+
+static void
+write_pending (BroadwayOutput *output)
+{
+  GPollableOutputStream *pollable = NULL;
+
+  if (output->out == NULL || output->pending_source != NULL)
+    return;
+
+  if (G_IS_POLLABLE_OUTPUT_STREAM (output->out) &&
+      g_pollable_output_stream_can_poll (G_POLLABLE_OUTPUT_STREAM (output->out)))
+    pollable = G_POLLABLE_OUTPUT_STREAM (output->out);
+
+  while (!g_queue_is_empty (&output->pending))
+    {
+      GBytes *frame = g_queue_peek_head (&output->pending);
+      const guchar *data;
+      gsize len;
+      gssize res;
+      GError *error = NULL;
+
+      data = g_bytes_get_data (frame, &len);
+
+      if (pollable)
+        res = g_pollable_output_stream_write_nonblocking (pollable,
+                                                          data + output->pending_offset,
+                                                          len - output->pending_offset,
+                                                          NULL, &error);
+      else if (g_output_stream_write_all (output->out,
+                                          data + output->pending_offset,
+                                          len - output->pending_offset,
+                                          NULL, NULL, &error))
+        res = len - output->pending_offset;
+      else
+        res = -1;
+
+      if (res < 0)
+        {
+          if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            {
+              output->pending_source = g_pollable_output_stream_create_source (pollable, NULL);
+              g_source_set_callback (output->pending_source,
+                                     (GSourceFunc) write_pending_cb, output, NULL);
+              g_source_attach (output->pending_source, NULL);
+            }
+          else
+            {
+              output->error = TRUE;
+              clear_pending (output);
+            }
+
+          g_error_free (error);
+          return;
+        }
+
+      output->pending_offset += res;
+      output->pending_size -= res;
+
+      if (output->pending_offset == len)
+        {
+          g_bytes_unref (g_queue_pop_head (&output->pending));
+          output->pending_offset = 0;
+        }
+    }
+}
+
 static void
 broadway_output_send_cmd (BroadwayOutput *output,
 			  gboolean fin, BroadwayWSOpCode code,
@@ -26,6 +131,7 @@ broadway_output_send_cmd (BroadwayOutput *output,
   gboolean mask = FALSE;
   guchar header[16];
   size_t p;
+  GByteArray *frame;
 
   gboolean mid_header = count > 125 && count <= 65535;
   gboolean long_header = count > 65535;
@@ -46,9 +152,16 @@ broadway_output_send_cmd (BroadwayOutput *output,
       p += 8;
     }
   // FIXME: if we are paranoid we should 'mask' the data
-  // FIXME: we should really emit these as a single write
-  g_output_stream_write_all (output->out, header, p, NULL, NULL, NULL);
-  g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
+  frame = g_byte_array_sized_new (p + count);
+  g_byte_array_append (frame, header, p);
+  g_byte_array_append (frame, buf, count);
+
+  output->pending_size += frame->len;
+  if (code == BROADWAY_WS_BINARY)
+    output->queued_bytes += frame->len;
+  g_queue_push_tail (&output->pending, g_byte_array_free_to_bytes (frame));
+
+  write_pending (output);
 }
 
 void broadway_output_pong (BroadwayOutput *output)
@@ -65,12 +178,15 @@ broadway_output_flush (BroadwayOutput *output)
   broadway_output_send_cmd (output, TRUE, BROADWAY_WS_BINARY,
                             output->buf->str, output->buf->len);
 
-  g_string_set_size (output->buf, 0);
+  broadway_output_clear (output);
 
   return !output->error;
 
 }
 
+/* @out may be %NULL for an output that only collects commands, which
+ * are then handed to other outputs with broadway_output_forward().
+ */
 BroadwayOutput *
 broadway_output_new (GOutputStream *out, guint32 serial)
 {
@@ -78,9 +194,11 @@ broadway_output_new (GOutputStream *out, guint32 serial)
 
   output = g_new0 (BroadwayOutput, 1);
 
-  output->out = g_object_ref (out);
+  output->out = out ? g_object_ref (out) : NULL;
   output->buf = g_string_new ("");
   output->serial = serial;
+  g_queue_init (&output->pending);
+  output->buffer_ranges = g_array_new (FALSE, FALSE, sizeof (BufferRange));
 
   return output;
 }
@@ -88,10 +206,94 @@ broadway_output_new (GOutputStream *out, guint32 serial)
 void
 broadway_output_free (BroadwayOutput *output)
 {
-  g_object_unref (output->out);
+  if (output->pending_source)
+    {
+      g_source_destroy (output->pending_source);
+      g_source_unref (output->pending_source);
+    }
+  clear_pending (output);
+  g_clear_object (&output->out);
+  g_string_free (output->buf, TRUE);
+  g_array_free (output->buffer_ranges, TRUE);
   free (output);
 }
 
+/* Sends the commands collected in @source to @output as one message.
+ * @source is left as is, so that the same commands can be forwarded to
+ * several outputs before calling broadway_output_clear() on it.
+ *
+ * If @drop_buffer is given, it is called for each buffer update in
+ * @source, and the update is left out if it returns %TRUE. This lets a
+ * peer on a slow link skip frames, the other commands are always sent.
+ */
+int
+broadway_output_forward (BroadwayOutput         *output,
+                         BroadwayOutput         *source,
+                         BroadwayDropBufferFunc  drop_buffer,
+                         gpointer                user_data)
+{
+  GString *filtered = NULL;
+  gsize start = 0;
+  guint i;
+
+  if (source->buf->len == 0)
+    return !output->error;
+
+  for (i = 0; drop_buffer != NULL && i < source->buffer_ranges->len; i++)
+    {
+      BufferRange *range = &g_array_index (source->buffer_ranges, BufferRange, i);
+
+      if (!drop_buffer (range->id, user_data))
+        continue;
+
+      if (filtered == NULL)
+        filtered = g_string_sized_new (source->buf->len);
+
+      g_string_append_len (filtered, source->buf->str + start, range->offset - start);
+      start = range->offset + range->length;
+    }
+
+  if (filtered == NULL)
+    {
+      broadway_output_send_cmd (output, TRUE, BROADWAY_WS_BINARY,
+                                source->buf->str, source->buf->len);
+      return !output->error;
+    }
+
+  g_string_append_len (filtered, source->buf->str + start, source->buf->len - start);
+
+  if (filtered->len > 0)
+    broadway_output_send_cmd (output, TRUE, BROADWAY_WS_BINARY,
+                              filtered->str, filtered->len);
+
+  g_string_free (filtered, TRUE);
+
+  return !output->error;
+}
+
+void
+broadway_output_clear (BroadwayOutput *output)
+{
+  g_string_set_size (output->buf, 0);
+  g_array_set_size (output->buffer_ranges, 0);
+}
+
+/* The number of bytes of messages ever queued on @output, for
+ * matching up with the acknowledgements of the peer */
+guint64
+broadway_output_get_queued_bytes (BroadwayOutput *output)
+{
+  return output->queued_bytes;
+}
+
+/* Bytes handed to broadway_output_flush() that the peer has not
+ * accepted yet */
+gsize
+broadway_output_get_pending_size (BroadwayOutput *output)
+{
+  return output->pending_size;
+}
+
 guint32
 broadway_output_get_next_serial (BroadwayOutput *output)
 {
@@ -286,26 +488,18 @@ broadway_output_set_transient_for (BroadwayOutput *output,
   append_uint16 (output, parent_id);
 }
 
-void
-broadway_output_put_buffer (BroadwayOutput *output,
-                            int             id,
-                            BroadwayBuffer *prev_buffer,
-                            BroadwayBuffer *buffer)
+/* Returns the compressed encoding of @buffer relative to @prev_buffer,
+ * or a keyframe if @prev_buffer is %NULL. The result only depends on
+ * the buffers, so it can be sent to any number of clients.
+ */
+GBytes *
+broadway_output_encode_buffer (BroadwayBuffer *prev_buffer,
+                               BroadwayBuffer *buffer)
 {
-  gsize len;
-  int w, h;
   GZlibCompressor *compressor;
   GOutputStream *out, *out_mem;
   GString *encoded;
-
-  write_header (output, BROADWAY_OP_PUT_BUFFER);
-
-  w = broadway_buffer_get_width (buffer);
-  h = broadway_buffer_get_height (buffer);
-
-  append_uint16 (output, id);
-  append_uint16 (output, w);
-  append_uint16 (output, h);
+  GBytes *bytes;
 
   encoded = g_string_new ("");
   broadway_buffer_encode (buffer, prev_buffer, encoded);
@@ -320,13 +514,86 @@ broadway_output_put_buffer (BroadwayOutput *output,
       !g_output_stream_close (out, NULL, NULL))
     g_warning ("compression failed");
 
-
-  len = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (out_mem));
-  append_uint32 (output, len);
-
-  g_string_append_len (output->buf, g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (out_mem)), len);
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (out_mem));
 
   g_string_free (encoded, TRUE);
   g_object_unref (out);
   g_object_unref (out_mem);
+
+  return bytes;
+}
+
+static void
+put_encoded_buffer (BroadwayOutput *output,
+                    char            op,
+                    int             id,
+                    int             w,
+                    int             h,
+                    GBytes         *encoded)
+{
+  BufferRange range;
+  gconstpointer data;
+  gsize len;
+
+  range.offset = output->buf->len;
+  range.id = id;
+
+  write_header (output, op);
+
+  append_uint16 (output, id);
+  append_uint16 (output, w);
+  append_uint16 (output, h);
+
+  data = g_bytes_get_data (encoded, &len);
+  append_uint32 (output, len);
+
+  g_string_append_len (output->buf, data, len);
+
+  range.length = output->buf->len - range.offset;
+  g_array_append_val (output->buffer_ranges, range);
+}
+
+void
+broadway_output_put_encoded_buffer (BroadwayOutput *output,
+                                    int             id,
+                                    int             w,
+                                    int             h,
+                                    GBytes         *encoded)
+{
+  put_encoded_buffer (output, BROADWAY_OP_PUT_BUFFER, id, w, h, encoded);
+}
+
+/* Like broadway_output_put_encoded_buffer(), but @encoded is a keyframe
+ * of size @w x @h that the browser scales up to the size of the surface.
+ */
+void
+broadway_output_put_scaled_buffer (BroadwayOutput *output,
+                                   int             id,
+                                   int             w,
+                                   int             h,
+                                   GBytes         *encoded)
+{
+  put_encoded_buffer (output, BROADWAY_OP_PUT_SCALED_BUFFER, id, w, h, encoded);
+}
+
+void
+broadway_output_put_buffer (BroadwayOutput *output,
+                            int             id,
+                            BroadwayBuffer *prev_buffer,
+                            BroadwayBuffer *buffer)
+{
+  GBytes *encoded;
+
+  encoded = broadway_output_encode_buffer (prev_buffer, buffer);
+  broadway_output_put_encoded_buffer (output, id,
+                                      broadway_buffer_get_width (buffer),
+                                      broadway_buffer_get_height (buffer),
+                                      encoded);
+  g_bytes_unref (encoded);
+}
+
+void
+broadway_output_reset (BroadwayOutput *output)
+{
+  write_header (output, BROADWAY_OP_RESET);
 }
@@ -8,6 +8,9 @@
 
 typedef struct BroadwayOutput BroadwayOutput;
 
+typedef gboolean (*BroadwayDropBufferFunc) (int      id,
+                                            gpointer user_data);
+
 typedef enum {
   BROADWAY_WS_CONTINUATION = 0,
   BROADWAY_WS_TEXT = 1,
@@ -22,6 +25,13 @@ BroadwayOutput *broadway_output_new             (GOutputStream  *out,
 void            broadway_output_free            (BroadwayOutput *output);
 int             broadway_output_flush           (BroadwayOutput *output);
 int             broadway_output_has_error       (BroadwayOutput *output);
+int             broadway_output_forward         (BroadwayOutput *output,
+                                                 BroadwayOutput *source,
+                                                 BroadwayDropBufferFunc drop_buffer,
+                                                 gpointer        user_data);
+void            broadway_output_clear           (BroadwayOutput *output);
+gsize           broadway_output_get_pending_size (BroadwayOutput *output);
+guint64         broadway_output_get_queued_bytes (BroadwayOutput *output);
 void            broadway_output_set_next_serial (BroadwayOutput *output,
 						 guint32         serial);
 guint32         broadway_output_get_next_serial (BroadwayOutput *output);
@@ -58,6 +68,19 @@ void            broadway_output_put_buffer      (BroadwayOutput *output,
 						 int             id,
                                                  BroadwayBuffer *prev_buffer,
                                                  BroadwayBuffer *buffer);
+GBytes *        broadway_output_encode_buffer   (BroadwayBuffer *prev_buffer,
+                                                 BroadwayBuffer *buffer);
+void            broadway_output_put_encoded_buffer (BroadwayOutput *output,
+                                                    int             id,
+                                                    int             w,
+                                                    int             h,
+                                                    GBytes         *encoded);
+void            broadway_output_put_scaled_buffer (BroadwayOutput *output,
+                                                   int             id,
+                                                   int             w,
+                                                   int             h,
+                                                   GBytes         *encoded);
+void            broadway_output_reset           (BroadwayOutput *output);
 void            broadway_output_grab_pointer    (BroadwayOutput *output,
 						 int id,
 						 gboolean owner_event);
@@ -23,7 +23,8 @@ typedef enum {
   BROADWAY_EVENT_CONFIGURE_NOTIFY = 'w',
   BROADWAY_EVENT_DELETE_NOTIFY = 'W',
   BROADWAY_EVENT_SCREEN_SIZE_CHANGED = 'd',
-  BROADWAY_EVENT_FOCUS = 'f'
+  BROADWAY_EVENT_FOCUS = 'f',
+  BROADWAY_EVENT_ACK = 'a'
 } BroadwayEventType;
 
 typedef enum {
@@ -43,6 +44,8 @@ typedef enum {
   BROADWAY_OP_DISCONNECTED = 'D',
   BROADWAY_OP_PUT_BUFFER = 'b',
   BROADWAY_OP_SET_SHOW_KEYBOARD = 'k',
+  BROADWAY_OP_RESET = 'x',
+  BROADWAY_OP_PUT_SCALED_BUFFER = 'B',
 } BroadwayOpType;
 
 typedef struct {
@@ -192,6 +195,8 @@ typedef struct {
   char name[36];
   guint32 width;
   guint32 height;
+  guint32 n_rects; /* damaged area, 0 if the whole surface changed */
+  BroadwayRect rects[1];
 } BroadwayRequestUpdate;
 
 typedef struct {
@@ -36,6 +36,40 @@
 #endif
 #include "fallback-memdup.h"
 
+/* A client whose connection has this much output queued up stops
+ * getting updates, and is brought up to date again once it caught up.
+ */
+#define MAX_PENDING_BYTES (4 * 1024 * 1024)
+
+/* Browsers acknowledge every message they handled. A client that has
+ * more unacknowledged data in flight than it can take in about two
+ * round trips has its buffer updates held back, the affected windows
+ * get a single keyframe of their latest contents once it caught up.
+ * This keeps the queue in front of slow links short, and merges the
+ * frames it could not have shown in time anyway.
+ */
+#define MIN_IN_FLIGHT_BYTES (128 * 1024)
+
+/* With lossy updates enabled, a keyframe that does not fit into the
+ * in-flight budget is sent with fewer colors, or scaled down while the
+ * user is scrolling, and is replaced with the real contents once
+ * nothing changed for this long.
+ */
+#define SCROLL_TIMEOUT_MS 300
+#define SETTLE_TIMEOUT_MS 500
+
+typedef enum {
+  WINDOW_UP_TO_DATE, /* not kept in the table */
+  WINDOW_STALE,      /* the browser has outdated contents */
+  WINDOW_REDUCED,    /* current contents, with fewer colors */
+  WINDOW_PREVIEW     /* current contents, scaled down */
+} WindowState;
+
+typedef struct {
+  gsize bytes;
+  gint64 time;
+} InFlightFrame;
+
 typedef struct BroadwayInput BroadwayInput;
 typedef struct BroadwayWindow BroadwayWindow;
 struct _BroadwayServer {
@@ -46,14 +80,20 @@ struct _BroadwayServer {
   char *ssl_cert;
   char *ssl_key;
   GSocketService *service;
-  BroadwayOutput *output;
+  BroadwayOutput *output; /* Collects commands for all clients */
   guint32 id_counter;
   guint32 saved_serial;
   guint64 last_seen_time;
-  BroadwayInput *input;
+  GList *clients;
+  BroadwayInput *input; /* The client that owns input, if any */
   GList *input_messages;
   guint process_input_idle;
 
+  gboolean lossy;
+  gint64 last_scroll_time;
+  guint settle_id;
+  guint flush_idle;
+
   GHashTable *id_ht;
   GList *toplevels;
   BroadwayWindow *root;
@@ -103,6 +143,18 @@ struct BroadwayInput {
   gboolean seen_time;
   gint64 time_base;
   gboolean active;
+  gboolean observer; /* Only watches, its input is ignored */
+  gboolean lagging;
+
+  /* Pacing */
+  GQueue in_flight; /* InFlightFrame, oldest first */
+  gsize in_flight_bytes;
+  guint64 queued_bytes;
+  gint64 last_ack_time;
+  gboolean busy; /* the link was in use since the last ack */
+  double throughput; /* bytes per second */
+  gint64 min_rtt;
+  GHashTable *windows; /* id -> WindowState, for windows not up to date */
 };
 
 struct BroadwayWindow {
@@ -117,12 +169,20 @@ struct BroadwayWindow {
 
   BroadwayBuffer *buffer;
   gboolean buffer_synced;
-
-  char *cached_surface_name;
-  cairo_surface_t *cached_surface;
+  gint64 last_update_time;
+  GBytes *keyframe; /* buffer encoded on its own, for new clients */
+  GBytes *reduced_keyframe;
+  GBytes *preview_keyframe;
+
+  /* Clients alternate between two surfaces, the most recent one first */
+  char *cached_surface_name[2];
+  cairo_surface_t *cached_surface[2];
 };
 
-static void broadway_server_resync_windows (BroadwayServer *server);
+static void broadway_server_resync_windows (BroadwayServer *server,
+                                            BroadwayOutput *output);
+static void track_frames (BroadwayInput *input);
+static void handle_ack (BroadwayInput *input);
 
 static GType broadway_server_get_type (void);
 
@@ -162,6 +222,11 @@ broadway_server_finalize (GObject *object)
   g_free (server->ssl_cert);
   g_free (server->ssl_key);
 
+  if (server->settle_id)
+    g_source_remove (server->settle_id);
+  if (server->flush_idle)
+    g_source_remove (server->flush_idle);
+
   G_OBJECT_CLASS (broadway_server_parent_class)->finalize (object);
 }
 
@@ -188,12 +253,33 @@ http_request_free (HttpRequest *request)
 static void
 broadway_input_free (BroadwayInput *input)
 {
+  broadway_output_free (input->output);
+  g_queue_clear_full (&input->in_flight, g_free);
+  g_hash_table_destroy (input->windows);
   g_object_unref (input->connection);
   g_byte_array_free (input->buffer, FALSE);
   g_source_destroy (input->source);
   g_free (input);
 }
 
+static void
+remove_client (BroadwayServer *server,
+               BroadwayInput  *input)
+{
+  server->clients = g_list_remove (server->clients, input);
+  if (server->input == input)
+    server->input = NULL;
+
+  broadway_input_free (input);
+
+  if (server->clients == NULL && server->output != NULL)
+    {
+      server->saved_serial = broadway_output_get_next_serial (server->output);
+      broadway_output_free (server->output);
+      server->output = NULL;
+    }
+}
+
 static void
 update_event_state (BroadwayServer *server,
 		    BroadwayInputMsg *message)
@@ -478,6 +564,7 @@ parse_input_message (BroadwayInput *input, const unsigned char *message)
     p = parse_pointer_data (p, &msg.pointer);
     update_future_pointer_info (server, &msg.pointer);
     msg.scroll.dir = ntohl (*p++);
+    server->last_scroll_time = g_get_monotonic_time ();
     break;
 
   case BROADWAY_EVENT_TOUCH:
@@ -623,7 +710,13 @@ parse_input (BroadwayInput *input)
             g_warning ("can't yet accept fragmented input");
 #endif
           }
-        else
+        else if (payload_len >= 8 &&
+                 GUINT32_FROM_BE (*(guint32 *) data) == BROADWAY_EVENT_ACK)
+          {
+            /* Observers acknowledge messages too */
+            handle_ack (input);
+          }
+        else if (!input->observer)
           {
             parse_input_message (input, data);
           }
@@ -688,9 +781,7 @@ broadway_server_read_all_input_nonblocking (BroadwayInput *input)
 	  return TRUE;
 	}
 
-      if (input->server->input == input)
-	input->server->input = NULL;
-      broadway_input_free (input);
+      remove_client (input->server, input);
       if (res < 0)
 	{
 	  g_printerr ("input error %s\n", error->message);
@@ -751,16 +842,374 @@ broadway_server_get_screen_size (BroadwayServer   *server,
 }
 
 
+/* Sends the client everything it needs to show the current state,
+ * using up serials so that later commands for all clients follow on.
+ */
+static void
+sync_client (BroadwayServer *server,
+             BroadwayInput  *input,
+             gboolean        reset)
+{
+  broadway_output_set_next_serial (input->output,
+                                   broadway_server_get_next_serial (server));
+
+  /* Drop whatever the client had from before it fell behind */
+  if (reset)
+    broadway_output_reset (input->output);
+
+  /* Every window gets its current contents */
+  g_hash_table_remove_all (input->windows);
+
+  broadway_server_resync_windows (server, input->output);
+
+  if (server->pointer_grab_window_id != -1)
+    broadway_output_grab_pointer (input->output,
+				  server->pointer_grab_window_id,
+				  server->pointer_grab_owner_events);
+
+  broadway_output_flush (input->output);
+  track_frames (input);
+
+  broadway_output_set_next_serial (server->output,
+                                   broadway_output_get_next_serial (input->output));
+}
+
+/* Keyframes are encoded at most once per buffer, however many clients
+ * join in the meantime.
+ */
+static GBytes *
+get_keyframe (BroadwayWindow *window)
+{
+  if (window->keyframe == NULL)
+    window->keyframe = broadway_output_encode_buffer (NULL, window->buffer);
+
+  return window->keyframe;
+}
+
+static GBytes *
+get_reduced_keyframe (BroadwayWindow *window,
+                      WindowState     state)
+{
+  BroadwayBuffer *reduced;
+  GBytes **keyframe;
+
+  keyframe = state == WINDOW_PREVIEW ? &window->preview_keyframe : &window->reduced_keyframe;
+  if (*keyframe == NULL)
+    {
+      reduced = broadway_buffer_create_reduced (window->buffer,
+                                                state == WINDOW_PREVIEW ? 2 : 1,
+                                                state == WINDOW_PREVIEW ? 4 : 5);
+      *keyframe = broadway_output_encode_buffer (NULL, reduced);
+      broadway_buffer_destroy (reduced);
+    }
+
+  return *keyframe;
+}
+
+static void
+clear_keyframes (BroadwayWindow *window)
+{
+  g_clear_pointer (&window->keyframe, g_bytes_unref);
+  g_clear_pointer (&window->reduced_keyframe, g_bytes_unref);
+  g_clear_pointer (&window->preview_keyframe, g_bytes_unref);
+}
+
+/* Remembers the messages sent to @input since the last call, they are
+ * taken off again as the browser acknowledges them.
+ */
+static void
+track_frames (BroadwayInput *input)
+{
+  InFlightFrame *frame;
+  guint64 queued;
+
+  queued = broadway_output_get_queued_bytes (input->output);
+  if (queued == input->queued_bytes)
+    return;
+
+  frame = g_new (InFlightFrame, 1);
+  frame->bytes = queued - input->queued_bytes;
+  frame->time = g_get_monotonic_time ();
+  input->queued_bytes = queued;
+
+  /* Throughput is only measured while the link is in use */
+  if (g_queue_is_empty (&input->in_flight))
+    {
+      input->last_ack_time = frame->time;
+      input->busy = TRUE;
+    }
+
+  g_queue_push_tail (&input->in_flight, frame);
+  input->in_flight_bytes += frame->bytes;
+}
+
+static gsize
+get_in_flight_budget (BroadwayInput *input)
+{
+  double bdp;
+
+  /* Twice the bandwidth-delay product, so that the estimate can grow */
+  bdp = input->throughput * input->min_rtt / G_USEC_PER_SEC;
+
+  return MAX (MIN_IN_FLIGHT_BYTES, 2 * bdp);
+}
+
+static gboolean
+is_over_budget (BroadwayInput *input)
+{
+  return input->in_flight_bytes > 0 &&
+         input->in_flight_bytes >= get_in_flight_budget (input);
+}
+
+static gboolean
+drop_buffer_cb (int      id,
+                gpointer user_data)
+{
+  BroadwayInput *input = user_data;
+
+  /* Updates are relative to contents the browser does not have */
+  if (g_hash_table_contains (input->windows, GINT_TO_POINTER (id)) ||
+      is_over_budget (input))
+    {
+      g_hash_table_insert (input->windows, GINT_TO_POINTER (id),
+                           GINT_TO_POINTER (WINDOW_STALE));
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static WindowState
+choose_keyframe (BroadwayServer *server,
+                 BroadwayInput  *input,
+                 BroadwayWindow *window)
+{
+  if (!server->lossy ||
+      g_bytes_get_size (get_keyframe (window)) <= get_in_flight_budget (input))
+    return WINDOW_UP_TO_DATE;
+
+  if (g_get_monotonic_time () - server->last_scroll_time < SCROLL_TIMEOUT_MS * 1000)
+    return WINDOW_PREVIEW;
+
+  return WINDOW_REDUCED;
+}
+
+static gboolean settle_cb (gpointer data);
+
+/* Sends keyframes for the windows @input does not have the current
+ * contents of, or for all windows that are not lossless and did not
+ * change for SETTLE_TIMEOUT_MS if @settle is set. The collected
+ * commands must have been forwarded already, so that serials keep
+ * increasing. */
+static void
+send_keyframes (BroadwayServer *server,
+                BroadwayInput  *input,
+                gboolean        settle)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  BroadwayWindow *window;
+  WindowState state;
+  gboolean sent = FALSE;
+  gint64 now;
+
+  now = g_get_monotonic_time ();
+
+  g_hash_table_iter_init (&iter, input->windows);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      if (!settle && GPOINTER_TO_INT (value) != WINDOW_STALE)
+        continue;
+
+      window = g_hash_table_lookup (server->id_ht, key);
+      if (window == NULL || window->buffer == NULL)
+        {
+          g_hash_table_iter_remove (&iter);
+          continue;
+        }
+
+      if (settle && now - window->last_update_time < SETTLE_TIMEOUT_MS * 1000)
+        continue;
+
+      if (!sent)
+        {
+          broadway_output_set_next_serial (input->output,
+                                           broadway_server_get_next_serial (server));
+          sent = TRUE;
+        }
+
+      state = settle ? WINDOW_UP_TO_DATE : choose_keyframe (server, input, window);
+      if (state == WINDOW_PREVIEW)
+        {
+          BroadwayBuffer *buffer = window->buffer;
+
+          broadway_output_put_scaled_buffer (input->output, window->id,
+                                             (broadway_buffer_get_width (buffer) + 1) / 2,
+                                             (broadway_buffer_get_height (buffer) + 1) / 2,
+                                             get_reduced_keyframe (window, state));
+        }
+      else
+        broadway_output_put_encoded_buffer (input->output, window->id,
+                                            broadway_buffer_get_width (window->buffer),
+                                            broadway_buffer_get_height (window->buffer),
+                                            state == WINDOW_REDUCED ?
+                                            get_reduced_keyframe (window, state) :
+                                            get_keyframe (window));
+
+      if (state == WINDOW_UP_TO_DATE)
+        g_hash_table_iter_remove (&iter);
+      else
+        g_hash_table_iter_replace (&iter, GINT_TO_POINTER (state));
+    }
+
+  if (!sent)
+    return;
+
+  broadway_output_flush (input->output);
+  broadway_output_set_next_serial (server->output,
+                                   broadway_output_get_next_serial (input->output));
+  track_frames (input);
+
+  if (g_hash_table_size (input->windows) > 0 && server->settle_id == 0)
+    server->settle_id = g_timeout_add (SETTLE_TIMEOUT_MS, settle_cb, server);
+}
+
+/* Replaces the lossy contents of each window with the real ones once
+ * it did not change for a while, and the links are idle. Windows that
+ * keep changing stay lossy without holding back the others.
+ */
+static gboolean
+settle_cb (gpointer data)
+{
+  BroadwayServer *server = data;
+  gboolean pending = FALSE;
+  GList *l;
+
+  broadway_server_flush (server);
+
+  for (l = server->clients; l != NULL; l = l->next)
+    {
+      BroadwayInput *input = l->data;
+
+      if (g_hash_table_size (input->windows) == 0 || input->lagging)
+        continue;
+
+      if (input->in_flight_bytes == 0)
+        send_keyframes (server, input, TRUE);
+
+      if (g_hash_table_size (input->windows) > 0)
+        pending = TRUE;
+    }
+
+  if (pending)
+    return G_SOURCE_CONTINUE;
+
+  server->settle_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+flush_idle_cb (gpointer data)
+{
+  BroadwayServer *server = data;
+
+  server->flush_idle = 0;
+  broadway_server_flush (server);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+handle_ack (BroadwayInput *input)
+{
+  BroadwayServer *server = input->server;
+  InFlightFrame *frame;
+  gint64 now, rtt;
+  double sample;
+
+  /* Messages are handled in order, so this is for the oldest one */
+  frame = g_queue_pop_head (&input->in_flight);
+  if (frame == NULL)
+    return;
+
+  now = g_get_monotonic_time ();
+  input->in_flight_bytes -= frame->bytes;
+
+  rtt = now - frame->time;
+  if (input->min_rtt == 0 || rtt < input->min_rtt)
+    input->min_rtt = rtt;
+  else
+    input->min_rtt += (rtt - input->min_rtt) / 64; /* follow route changes */
+
+  if (input->busy && now > input->last_ack_time)
+    {
+      sample = (double) frame->bytes * G_USEC_PER_SEC / (now - input->last_ack_time);
+      if (input->throughput == 0)
+        input->throughput = sample;
+      else
+        input->throughput = (7 * input->throughput + sample) / 8;
+    }
+
+  input->last_ack_time = now;
+  input->busy = !g_queue_is_empty (&input->in_flight);
+
+  g_free (frame);
+
+  /* Catch up on the frames that were held back. This is done from an
+   * idle, as flushing may drop clients, including this one. */
+  if (g_hash_table_size (input->windows) > 0 && !is_over_budget (input) &&
+      server->flush_idle == 0)
+    server->flush_idle = g_idle_add (flush_idle_cb, server);
+}
+
 void
 broadway_server_flush (BroadwayServer *server)
 {
-  if (server->output &&
-      !broadway_output_flush (server->output))
+  GList *l, *next;
+
+  if (server->output == NULL)
+    return;
+
+  for (l = server->clients; l != NULL; l = next)
     {
-      server->saved_serial = broadway_output_get_next_serial (server->output);
-      broadway_output_free (server->output);
-      server->output = NULL;
+      BroadwayInput *input = l->data;
+
+      next = l->next;
+
+      if (input->lagging)
+        {
+          /* Once it has caught up, start it over from the current
+           * state, which already includes the pending commands.
+           */
+          if (broadway_output_get_pending_size (input->output) == 0)
+            {
+              input->lagging = FALSE;
+              sync_client (server, input, TRUE);
+            }
+          continue;
+        }
+
+      if (broadway_output_get_pending_size (input->output) > MAX_PENDING_BYTES)
+        {
+          input->lagging = TRUE;
+          continue;
+        }
+
+      if (!broadway_output_forward (input->output, server->output,
+                                    drop_buffer_cb, input))
+        {
+          remove_client (server, input);
+          continue;
+        }
+
+      track_frames (input);
+
+      if (!is_over_budget (input))
+        send_keyframes (server, input, FALSE);
     }
+
+  if (server->output)
+    broadway_output_clear (server->output);
 }
 
 #if 0
@@ -969,7 +1418,8 @@ generate_handshake_response_wsietf_v7 (const gchar *key)
 }
 
 static void
-start_input (HttpRequest *request)
+start_input (HttpRequest *request,
+             gboolean     observer)
 {
   char **lines;
   char *p;
@@ -1048,6 +1498,9 @@ start_input (HttpRequest *request)
   input = g_new0 (BroadwayInput, 1);
   input->server = request->server;
   input->connection = g_object_ref (request->connection);
+  input->observer = observer;
+  g_queue_init (&input->in_flight);
+  input->windows = g_hash_table_new (NULL, NULL);
 
   data_buffer = g_buffered_input_stream_peek_buffer (G_BUFFERED_INPUT_STREAM (request->data), &data_buffer_size);
   input->buffer = g_byte_array_sized_new (data_buffer_size);
@@ -1082,36 +1535,28 @@ start (BroadwayInput *input)
 
   server = BROADWAY_SERVER (input->server);
 
-  if (server->output)
-    {
-      broadway_output_disconnected (server->output);
-      broadway_output_flush (server->output);
-    }
+  /* Get the other clients up to date, the new one gets the current
+   * state in full.
+   */
+  broadway_server_flush (server);
 
-  if (server->input != NULL)
+  /* A new input owner replaces the old one, observers are added */
+  if (!input->observer && server->input != NULL)
     {
-      broadway_input_free (server->input);
-      server->input = NULL;
+      broadway_output_disconnected (server->input->output);
+      broadway_output_flush (server->input->output);
+      remove_client (server, server->input);
     }
 
-  server->input = input;
-
-  if (server->output)
-    {
-      server->saved_serial = broadway_output_get_next_serial (server->output);
-      broadway_output_free (server->output);
-    }
-  server->output = input->output;
+  if (!input->observer)
+    server->input = input;
 
-  broadway_output_set_next_serial (server->output, server->saved_serial);
-  broadway_output_flush (server->output);
+  if (server->output == NULL)
+    server->output = broadway_output_new (NULL, server->saved_serial);
 
-  broadway_server_resync_windows (server);
+  server->clients = g_list_append (server->clients, input);
 
-  if (server->pointer_grab_window_id != -1)
-    broadway_output_grab_pointer (server->output,
-				  server->pointer_grab_window_id,
-				  server->pointer_grab_owner_events);
+  sync_client (server, input, FALSE);
 
   process_input_messages (server);
 }
@@ -1141,6 +1586,25 @@ send_data (HttpRequest *request,
 #include "clienthtml.h"
 #include "broadwayjs.h"
 
+static gboolean
+has_query_param (const char *query,
+                 const char *name)
+{
+  char **params;
+  gboolean found = FALSE;
+  int i;
+
+  params = g_strsplit (query, "&", -1);
+  for (i = 0; params[i] != NULL; i++)
+    {
+      if (strcmp (params[i], name) == 0)
+        found = TRUE;
+    }
+  g_strfreev (params);
+
+  return found;
+}
+
 static void
 got_request (HttpRequest *request)
 {
@@ -1173,14 +1637,14 @@ got_request (HttpRequest *request)
 
   query = strchr (escaped, '?');
   if (query)
-    *query = 0;
+    *query++ = 0;
 
   if (strcmp (escaped, "/client.html") == 0 || strcmp (escaped, "/") == 0)
     send_data (request, "text/html", client_html, G_N_ELEMENTS(client_html) - 1);
   else if (strcmp (escaped, "/broadway.js") == 0)
     send_data (request, "text/javascript", broadway_js, G_N_ELEMENTS(broadway_js) - 1);
   else if (strcmp (escaped, "/socket") == 0)
-    start_input (request);
+    start_input (request, query != NULL && has_query_param (query, "observe"));
   else
     send_error (request, 404, "File not found");
 
@@ -1438,6 +1902,7 @@ broadway_server_destroy_window (BroadwayServer *server,
 				gint id)
 {
   BroadwayWindow *window;
+  guint i;
 
   if (server->mouse_in_toplevel_id == id)
     {
@@ -1460,9 +1925,13 @@ broadway_server_destroy_window (BroadwayServer *server,
       g_hash_table_remove (server->id_ht,
 			   GINT_TO_POINTER (id));
 
-      g_free (window->cached_surface_name);
-      if (window->cached_surface != NULL)
-	cairo_surface_destroy (window->cached_surface);
+      for (i = 0; i < G_N_ELEMENTS (window->cached_surface); i++)
+        {
+          g_free (window->cached_surface_name[i]);
+          if (window->cached_surface[i] != NULL)
+            cairo_surface_destroy (window->cached_surface[i]);
+        }
+      clear_keyframes (window);
 
       g_free (window);
     }
@@ -1540,6 +2009,14 @@ broadway_server_window_raise (BroadwayServer *server,
     broadway_output_raise_surface (server->output, window->id);
 }
 
+/* Allows sending lossy keyframes to clients that cannot keep up */
+void
+broadway_server_set_lossy (BroadwayServer *server,
+                           gboolean        lossy)
+{
+  server->lossy = lossy;
+}
+
 void
 broadway_server_set_show_keyboard (BroadwayServer *server,
                                    gboolean show)
@@ -1600,10 +2077,12 @@ broadway_server_has_client (BroadwayServer *server)
 void
 broadway_server_window_update (BroadwayServer *server,
 			       gint id,
-			       cairo_surface_t *surface)
+			       cairo_surface_t *surface,
+			       cairo_region_t *damage)
 {
   BroadwayWindow *window;
   BroadwayBuffer *buffer;
+  BroadwayBufferStats stats;
 
   if (surface == NULL)
     return;
@@ -1618,19 +2097,31 @@ broadway_server_window_update (BroadwayServer *server,
 
   buffer = broadway_buffer_create (window->width, window->height,
                                    cairo_image_surface_get_data (surface),
-                                   cairo_image_surface_get_stride (surface));
+                                   cairo_image_surface_get_stride (surface),
+                                   window->buffer, damage);
 
   if (server->output != NULL)
     {
       window->buffer_synced = TRUE;
       broadway_output_put_buffer (server->output, window->id,
                                   window->buffer, buffer);
+
+      broadway_buffer_get_stats (buffer, &stats);
+      g_debug ("window %d: %d/%d blocks damaged, %d matched, %d clashes, "
+               "probes %d/%d/%d/%d/%d, %d bytes",
+               window->id, stats.damaged_blocks, stats.blocks,
+               stats.matches, stats.clashes,
+               stats.collisions[0], stats.collisions[1], stats.collisions[2],
+               stats.collisions[3], stats.collisions[4], stats.bytes);
     }
 
   if (window->buffer)
     broadway_buffer_destroy (window->buffer);
 
   window->buffer = buffer;
+  clear_keyframes (window);
+
+  window->last_update_time = g_get_monotonic_time ();
 }
 
 gboolean
@@ -1656,13 +2147,14 @@ broadway_server_window_move_resize (BroadwayServer *server,
   window->height = height;
 
   if (server->output != NULL)
-    {
-      broadway_output_move_resize_surface (server->output,
-					   window->id,
-					   with_move, x, y,
-					   with_resize, window->width, window->height);
-      sent = TRUE;
-    }
+    broadway_output_move_resize_surface (server->output,
+                                         window->id,
+                                         with_move, x, y,
+                                         with_resize, window->width, window->height);
+
+  /* Only the client that owns input reports back configure events */
+  if (server->input != NULL)
+    sent = TRUE;
   else
     {
       if (with_move)
@@ -1787,6 +2279,7 @@ broadway_server_open_surface (BroadwayServer *server,
   BroadwayWindow *window;
   ShmSurfaceData *data;
   cairo_surface_t *surface;
+  char *cached_name;
   gsize size;
   void *ptr;
 
@@ -1795,9 +2288,22 @@ broadway_server_open_surface (BroadwayServer *server,
   if (window == NULL)
     return NULL;
 
-  if (window->cached_surface_name != NULL &&
-      strcmp (name, window->cached_surface_name) == 0)
-    return cairo_surface_reference (window->cached_surface);
+  if (window->cached_surface_name[0] != NULL &&
+      strcmp (name, window->cached_surface_name[0]) == 0)
+    return cairo_surface_reference (window->cached_surface[0]);
+
+  if (window->cached_surface_name[1] != NULL &&
+      strcmp (name, window->cached_surface_name[1]) == 0)
+    {
+      surface = window->cached_surface[1];
+      window->cached_surface[1] = window->cached_surface[0];
+      window->cached_surface[0] = surface;
+      cached_name = window->cached_surface_name[1];
+      window->cached_surface_name[1] = window->cached_surface_name[0];
+      window->cached_surface_name[0] = cached_name;
+
+      return cairo_surface_reference (surface);
+    }
 
   size = width * height * sizeof (guint32);
 
@@ -1820,12 +2326,15 @@ broadway_server_open_surface (BroadwayServer *server,
   cairo_surface_set_user_data (surface, &shm_cairo_key,
 			       data, shm_data_unmap);
 
-  g_free (window->cached_surface_name);
-  window->cached_surface_name = g_strdup (name);
+  /* Forget the older one */
+  g_free (window->cached_surface_name[1]);
+  if (window->cached_surface[1] != NULL)
+    cairo_surface_destroy (window->cached_surface[1]);
 
-  if (window->cached_surface != NULL)
-    cairo_surface_destroy (window->cached_surface);
-  window->cached_surface = cairo_surface_reference (surface);
+  window->cached_surface_name[1] = window->cached_surface_name[0];
+  window->cached_surface[1] = window->cached_surface[0];
+  window->cached_surface_name[0] = g_strdup (name);
+  window->cached_surface[0] = cairo_surface_reference (surface);
 
   return surface;
 }
@@ -1868,20 +2377,19 @@ broadway_server_new_window (BroadwayServer *server,
 				 window->width,
 				 window->height,
 				 window->is_temp);
-  else
+
+  if (server->input == NULL)
     fake_configure_notify (server, window);
 
   return window->id;
 }
 
 static void
-broadway_server_resync_windows (BroadwayServer *server)
+broadway_server_resync_windows (BroadwayServer *server,
+                                BroadwayOutput *output)
 {
   GList *l;
 
-  if (server->output == NULL)
-    return;
-
   /* First create all windows */
   for (l = server->toplevels; l != NULL; l = l->next)
     {
@@ -1891,7 +2399,7 @@ broadway_server_resync_windows (BroadwayServer *server)
 	continue; /* Skip root */
 
       window->buffer_synced = FALSE;
-      broadway_output_new_surface (server->output,
+      broadway_output_new_surface (output,
 				   window->id,
 				   window->x,
 				   window->y,
@@ -1909,22 +2417,22 @@ broadway_server_resync_windows (BroadwayServer *server)
 	continue; /* Skip root */
 
       if (window->transient_for != -1)
-	broadway_output_set_transient_for (server->output, window->id, window->transient_for);
+	broadway_output_set_transient_for (output, window->id, window->transient_for);
       if (window->visible)
 	{
-	  broadway_output_show_surface (server->output, window->id);
+	  broadway_output_show_surface (output, window->id);
 
 	  if (window->buffer != NULL)
 	    {
 	      window->buffer_synced = TRUE;
-              broadway_output_put_buffer (server->output, window->id,
-                                          NULL, window->buffer);
+              broadway_output_put_encoded_buffer (output, window->id,
+                                                  broadway_buffer_get_width (window->buffer),
+                                                  broadway_buffer_get_height (window->buffer),
+                                                  get_keyframe (window));
 	    }
 	}
     }
 
   if (server->show_keyboard)
-    broadway_output_set_show_keyboard (server->output, TRUE);
-
-  broadway_server_flush (server);
+    broadway_output_set_show_keyboard (output, TRUE);
 }
@@ -52,6 +52,8 @@ guint32             broadway_server_ungrab_pointer           (BroadwayServer   *
 gint32              broadway_server_get_mouse_toplevel       (BroadwayServer   *server);
 void                broadway_server_set_show_keyboard        (BroadwayServer   *server,
                                                               gboolean          show);
+void                broadway_server_set_lossy                (BroadwayServer   *server,
+                                                              gboolean          lossy);
 guint32             broadway_server_new_window               (BroadwayServer   *server,
 							      int               x,
 							      int               y,
@@ -80,7 +82,8 @@ cairo_surface_t   * broadway_server_create_surface           (int
 							      int               height);
 void                broadway_server_window_update            (BroadwayServer   *server,
 							      gint              id,
-							      cairo_surface_t  *surface);
+							      cairo_surface_t  *surface,
+							      cairo_region_t   *damage);
 gboolean            broadway_server_window_move_resize       (BroadwayServer   *server,
 							      gint              id,
 							      gboolean          with_move,
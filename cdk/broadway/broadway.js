@@ -102,7 +102,9 @@ var surfaces = {};
 var stackingOrder = [];
 var outstandingCommands = new Array();
 var inputSocket = null;
+var ws = null;
 var debugDecoding = false;
+var observe = false;
 var fakeInput = null;
 var showKeyboard = false;
 var showKeyboardChanged = false;
@@ -528,6 +530,26 @@ function cmdPutBuffer(id, w, h, compressed)
     surface.imageData = imageData;
 }
 
+/* A lossy keyframe at a lower resolution, it is replaced with the real
+ * contents later. */
+function cmdPutScaledBuffer(id, w, h, compressed)
+{
+    var surface = surfaces[id];
+    var context = surface.canvas.getContext("2d");
+
+    var inflate = new Zlib.RawInflate(compressed);
+    var data = inflate.decompress();
+
+    var scaled = document.createElement("canvas");
+    scaled.width = w;
+    scaled.height = h;
+    var scaledContext = scaled.getContext("2d");
+    scaledContext.putImageData(decodeBuffer (scaledContext, null, w, h, data, false), 0, 0);
+
+    context.drawImage(scaled, 0, 0, surface.canvas.width, surface.canvas.height);
+    surface.imageData = context.getImageData(0, 0, surface.canvas.width, surface.canvas.height);
+}
+
 function cmdGrabPointer(id, ownerEvents)
 {
     doGrab(id, ownerEvents, false);
@@ -624,6 +646,14 @@ function handleCommands(cmd)
             cmdPutBuffer(id, w, h, data);
             break;
 
+	case 'B': // Put scaled down image buffer
+	    id = cmd.get_16();
+	    w = cmd.get_16();
+	    h = cmd.get_16();
+            var data = cmd.get_data();
+            cmdPutScaledBuffer(id, w, h, data);
+            break;
+
 	case 'g': // Grab
 	    id = cmd.get_16();
 	    var ownerEvents = cmd.get_bool ();
@@ -640,6 +670,11 @@ function handleCommands(cmd)
             showKeyboardChanged = true;
             break;
 
+	case 'x': // Reset, we fell behind and get everything resent
+	    for (id in surfaces)
+		cmdDeleteSurface(id);
+	    break;
+
 	default:
 	    alert("Unknown op " + command);
 	}
@@ -655,6 +690,7 @@ function handleOutstanding()
 	    outstandingCommands.unshift(cmd);
 	    return;
 	}
+	sendAck();
     }
 }
 
@@ -735,6 +771,22 @@ function sendInput(cmd, args)
     inputSocket.send(buffer);
 }
 
+/* Tells the server that a message was handled, so it can pace its
+ * updates. This is sent by observers too. */
+function sendAck()
+{
+    if (ws == null || ws.readyState != WebSocket.OPEN)
+        return;
+
+    var buffer = new ArrayBuffer(3 * 4);
+    var view = new DataView(buffer);
+    view.setInt32(0, "a".charCodeAt(0), false);
+    view.setInt32(4, lastSerial, false);
+    view.setInt32(8, 0, false);
+
+    ws.send(buffer);
+}
+
 function getPositionsFromAbsCoord(absX, absY, relativeId) {
     var res = Object();
 
@@ -2609,16 +2661,22 @@ function connect()
             var pair = params[i].split("=");
             if (pair[0] == "debug" && pair[1] == "decoding")
                 debugDecoding = true;
+            if (pair[0] == "observe")
+                observe = true;
         }
     }
 
     var loc = window.location.toString().replace("http:", "ws:").replace("https:", "wss:");
     loc = loc.substr(0, loc.lastIndexOf('/')) + "/socket";
+    if (observe)
+        loc = loc + "?observe";
     ws = new WebSocket(loc, "broadway");
     ws.binaryType = "arraybuffer";
 
     ws.onopen = function() {
-	inputSocket = ws;
+	/* Observers only watch, they never send input */
+	if (!observe)
+	    inputSocket = ws;
     };
     ws.onclose = function() {
 	if (inputSocket != null)
@@ -37,6 +37,7 @@ struct _CdkBroadwayServer {
   GObject parent_instance;
 
   guint32 next_serial;
+  guint32 synced_serial; /* the last sync request that was answered */
   GSocketConnection *connection;
 
   guint32 recv_buffer_size;
@@ -320,6 +321,8 @@ process_input_messages (CdkBroadwayServer *server)
 
       if (reply->base.type == BROADWAY_REPLY_EVENT)
 	_cdk_broadway_events_got_input (&reply->event.msg);
+      else if (reply->base.type == BROADWAY_REPLY_SYNC)
+	server->synced_serial = MAX (server->synced_serial, reply->base.in_reply_to);
       else
 	g_warning ("Unhandled reply type %d", reply->base.type);
       g_free (reply);
@@ -386,22 +389,44 @@ _cdk_broadway_server_flush (CdkBroadwayServer *server)
   cdk_broadway_server_send_message(server, msg, BROADWAY_REQUEST_FLUSH);
 }
 
-void
-_cdk_broadway_server_sync (CdkBroadwayServer *server)
+/* Sends a sync request without waiting for the reply, see
+ * _cdk_broadway_server_wait_for_sync().
+ */
+guint32
+_cdk_broadway_server_send_sync (CdkBroadwayServer *server)
 {
   BroadwayRequestSync msg;
-  guint32 serial;
+
+  return cdk_broadway_server_send_message (server, msg,
+					   BROADWAY_REQUEST_SYNC);
+}
+
+/* Waits until the daemon handled the sync request with @serial, and
+ * so everything sent before it. Returns right away if the reply was
+ * seen already.
+ */
+void
+_cdk_broadway_server_wait_for_sync (CdkBroadwayServer *server,
+				    guint32            serial)
+{
   BroadwayReply *reply;
 
-  serial = cdk_broadway_server_send_message (server, msg,
-					     BROADWAY_REQUEST_SYNC);
+  if (serial <= server->synced_serial)
+    return;
+
   reply = cdk_broadway_server_wait_for_reply (server, serial);
 
   g_assert (reply->base.type == BROADWAY_REPLY_SYNC);
+  server->synced_serial = MAX (server->synced_serial, serial);
 
   g_free (reply);
+}
 
-  return;
+void
+_cdk_broadway_server_sync (CdkBroadwayServer *server)
+{
+  _cdk_broadway_server_wait_for_sync (server,
+				      _cdk_broadway_server_send_sync (server));
 }
 
 void
@@ -729,13 +754,20 @@ _cdk_broadway_server_create_surface (int                 width,
   return surface;
 }
 
+/* More rectangles than this are sent as their extents */
+#define MAX_DAMAGE_RECTS 32
+
 void
 _cdk_broadway_server_window_update (CdkBroadwayServer *server,
 				    gint id,
-				    cairo_surface_t *surface)
+				    cairo_surface_t *surface,
+				    cairo_region_t *damage)
 {
-  BroadwayRequestUpdate msg;
+  BroadwayRequestUpdate *msg;
   BroadwayShmSurfaceData *data;
+  cairo_rectangle_int_t rect;
+  gsize size;
+  int i, n_rects;
 
   if (surface == NULL)
     return;
@@ -743,13 +775,34 @@ _cdk_broadway_server_window_update (CdkBroadwayServer *server,
   data = cairo_surface_get_user_data (surface, &cdk_broadway_shm_cairo_key);
   g_assert (data != NULL);
 
-  msg.id = id;
-  memcpy (msg.name, data->name, 36);
-  msg.width = cairo_image_surface_get_width (surface);
-  msg.height = cairo_image_surface_get_height (surface);
+  n_rects = damage ? cairo_region_num_rectangles (damage) : 0;
+  if (n_rects > MAX_DAMAGE_RECTS)
+    n_rects = 1;
 
-  cdk_broadway_server_send_message (server, msg,
-				    BROADWAY_REQUEST_UPDATE);
+  size = sizeof (BroadwayRequestUpdate) + sizeof (BroadwayRect) * MAX (n_rects - 1, 0);
+  msg = g_alloca (size);
+
+  msg->id = id;
+  memcpy (msg->name, data->name, 36);
+  msg->width = cairo_image_surface_get_width (surface);
+  msg->height = cairo_image_surface_get_height (surface);
+  msg->n_rects = n_rects;
+
+  for (i = 0; i < n_rects; i++)
+    {
+      if (n_rects < cairo_region_num_rectangles (damage))
+        cairo_region_get_extents (damage, &rect);
+      else
+        cairo_region_get_rectangle (damage, i, &rect);
+
+      msg->rects[i].x = rect.x;
+      msg->rects[i].y = rect.y;
+      msg->rects[i].width = rect.width;
+      msg->rects[i].height = rect.height;
+    }
+
+  cdk_broadway_server_send_message_with_size (server, (BroadwayRequestBase *) msg, size,
+					      BROADWAY_REQUEST_UPDATE);
 }
 
 gboolean
@@ -18,6 +18,9 @@ CdkBroadwayServer *_cdk_broadway_server_new                      (const char
 								  GError            **error);
 void               _cdk_broadway_server_flush                    (CdkBroadwayServer  *server);
 void               _cdk_broadway_server_sync                     (CdkBroadwayServer  *server);
+guint32            _cdk_broadway_server_send_sync                (CdkBroadwayServer  *server);
+void               _cdk_broadway_server_wait_for_sync            (CdkBroadwayServer  *server,
+								  guint32             serial);
 gulong             _cdk_broadway_server_get_next_serial          (CdkBroadwayServer  *server);
 guint32            _cdk_broadway_server_get_last_seen_time       (CdkBroadwayServer  *server);
 gboolean           _cdk_broadway_server_lookahead_event          (CdkBroadwayServer  *server,
@@ -63,7 +66,8 @@ cairo_surface_t   *_cdk_broadway_server_create_surface           (int
 								  int                 height);
 void               _cdk_broadway_server_window_update            (CdkBroadwayServer  *server,
 								  gint                id,
-								  cairo_surface_t    *surface);
+								  cairo_surface_t    *surface,
+								  cairo_region_t     *damage);
 gboolean           _cdk_broadway_server_window_move_resize       (CdkBroadwayServer  *server,
 								  gint                id,
 								  gboolean            with_move,
@@ -262,10 +262,30 @@ client_handle_request (BroadwayClient *client,
 					      request->update.height);
       if (surface != NULL)
 	{
+	  cairo_region_t *damage = NULL;
+	  cairo_rectangle_int_t rect;
+	  guint32 i;
+
+	  if (request->update.n_rects > 0)
+	    {
+	      damage = cairo_region_create ();
+	      for (i = 0; i < request->update.n_rects; i++)
+		{
+		  rect.x = request->update.rects[i].x;
+		  rect.y = request->update.rects[i].y;
+		  rect.width = request->update.rects[i].width;
+		  rect.height = request->update.rects[i].height;
+		  cairo_region_union_rectangle (damage, &rect);
+		}
+	    }
+
 	  broadway_server_window_update (server,
 					 request->update.id,
-					 surface);
+					 surface,
+					 damage);
 	  cairo_surface_destroy (surface);
+	  if (damage)
+	    cairo_region_destroy (damage);
 	}
       break;
     case BROADWAY_REQUEST_MOVE_RESIZE:
@@ -421,6 +441,7 @@ main (int argc, char *argv[])
   int http_port = 0;
   char *ssl_cert = NULL;
   char *ssl_key = NULL;
+  gboolean lossy = FALSE;
   char *display;
   int port = 0;
   const GOptionEntry entries[] = {
@@ -431,6 +452,7 @@ main (int argc, char *argv[])
 #endif
     { "cert", 'c', 0, G_OPTION_ARG_STRING, &ssl_cert, "SSL certificate path", "PATH" },
     { "key", 'k', 0, G_OPTION_ARG_STRING, &ssl_key, "SSL key path", "PATH" },
+    { "lossy", 0, 0, G_OPTION_ARG_NONE, &lossy, "Send lossy updates to clients on slow links", NULL },
     { NULL }
   };
 
@@ -514,6 +536,8 @@ main (int argc, char *argv[])
       return 1;
     }
 
+  broadway_server_set_lossy (server, lossy);
+
   listener = g_socket_service_new ();
   if (!g_socket_listener_add_address (G_SOCKET_LISTENER (listener),
 				      address,
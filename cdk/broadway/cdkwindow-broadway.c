@@ -105,12 +105,82 @@ find_broadway_display (void)
   return display;
 }
 
+static void
+drop_ref_surface (CdkWindowImplBroadway *impl)
+{
+  if (impl->ref_surface)
+    {
+      cairo_surface_set_user_data (impl->ref_surface, &cdk_broadway_cairo_key,
+				   NULL, NULL);
+      impl->ref_surface = NULL;
+    }
+}
+
+static void
+clear_last_surface (CdkWindowImplBroadway *impl)
+{
+  CdkBroadwayDisplay *display;
+
+  if (impl->last_surface == NULL)
+    return;
+
+  /* The daemon may not have opened it yet */
+  display = CDK_BROADWAY_DISPLAY (cdk_window_get_display (impl->wrapper));
+  _cdk_broadway_server_wait_for_sync (display->server, impl->last_surface_serial);
+
+  g_clear_pointer (&impl->last_surface, cairo_surface_destroy);
+}
+
+/* Each window has two shared memory buffers. While the daemon reads the
+ * one that was just sent, the next frame is painted into the other one,
+ * so there is no need to wait for the daemon after every frame. The
+ * buffers only differ in what was painted last, which is copied over.
+ */
+static void
+swap_surfaces (CdkBroadwayServer     *server,
+	       CdkWindowImplBroadway *impl,
+	       guint32                serial)
+{
+  cairo_surface_t *front;
+  cairo_t *cr;
+
+  front = impl->surface;
+
+  if (impl->last_surface == NULL)
+    {
+      impl->last_surface =
+	_cdk_broadway_server_create_surface (cairo_image_surface_get_width (front),
+					     cairo_image_surface_get_height (front));
+      g_clear_pointer (&impl->damage, cairo_region_destroy);
+    }
+  else
+    _cdk_broadway_server_wait_for_sync (server, impl->last_surface_serial);
+
+  cr = cairo_create (impl->last_surface);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_set_source_surface (cr, front, 0, 0);
+  if (impl->damage)
+    {
+      cdk_cairo_region (cr, impl->damage);
+      cairo_clip (cr);
+    }
+  cairo_paint (cr);
+  cairo_destroy (cr);
+
+  impl->surface = impl->last_surface;
+  impl->last_surface = front;
+  impl->last_surface_serial = serial;
+
+  drop_ref_surface (impl);
+}
+
 static void
 update_dirty_windows_and_sync (void)
 {
   GList *l;
   CdkBroadwayDisplay *display;
   gboolean updated_surface;
+  guint32 serial;
 
   display = CDK_BROADWAY_DISPLAY (find_broadway_display ());
   g_assert (display != NULL);
@@ -122,20 +192,35 @@ update_dirty_windows_and_sync (void)
 
       if (impl->dirty)
 	{
-	  impl->dirty = FALSE;
 	  updated_surface = TRUE;
 	  _cdk_broadway_server_window_update (display->server,
 					      impl->id,
-					      impl->surface);
+					      impl->surface,
+					      impl->damage);
 	}
     }
 
-  /* We sync here to ensure all references to the impl->surface memory
-     is done, as we may later paint new data in them. */
-  if (updated_surface)
-    cdk_display_sync (CDK_DISPLAY (display));
-  else
-    cdk_display_flush (CDK_DISPLAY (display));
+  if (!updated_surface)
+    {
+      cdk_display_flush (CDK_DISPLAY (display));
+      return;
+    }
+
+  /* The daemon is done with the surfaces once it answered this */
+  serial = _cdk_broadway_server_send_sync (display->server);
+
+  for (l = display->toplevels; l != NULL; l = l->next)
+    {
+      CdkWindowImplBroadway *impl = l->data;
+
+      if (impl->dirty)
+	{
+	  impl->dirty = FALSE;
+	  if (impl->surface)
+	    swap_surfaces (display->server, impl, serial);
+	  g_clear_pointer (&impl->damage, cairo_region_destroy);
+	}
+    }
 }
 
 static guint flush_id = 0;
@@ -195,6 +280,8 @@ cdk_window_impl_broadway_finalize (GObject *object)
 
   g_hash_table_destroy (impl->device_cursor);
 
+  g_clear_pointer (&impl->damage, cairo_region_destroy);
+
   broadway_display->toplevels = g_list_remove (broadway_display->toplevels, impl);
 
   G_OBJECT_CLASS (cdk_window_impl_broadway_parent_class)->finalize (object);
@@ -306,12 +393,12 @@ _cdk_broadway_window_resize_surface (CdkWindow *window)
 							   cdk_window_get_height (impl->wrapper));
     }
 
-  if (impl->ref_surface)
-    {
-      cairo_surface_set_user_data (impl->ref_surface, &cdk_broadway_cairo_key,
-				   NULL, NULL);
-      impl->ref_surface = NULL;
-    }
+  clear_last_surface (impl);
+
+  /* The new surface has to be sent in full */
+  g_clear_pointer (&impl->damage, cairo_region_destroy);
+
+  drop_ref_surface (impl);
 
   cdk_window_invalidate_rect (window, NULL, TRUE);
 }
@@ -386,6 +473,8 @@ _cdk_broadway_window_destroy (CdkWindow *window,
       impl->surface = NULL;
     }
 
+  clear_last_surface (impl);
+
   broadway_display = CDK_BROADWAY_DISPLAY (cdk_window_get_display (window));
   g_hash_table_remove (broadway_display->id_ht, GINT_TO_POINTER(impl->id));
 
@@ -1047,6 +1136,14 @@ cdk_broadway_window_end_paint (CdkWindow *window)
 {
   CdkWindowImplBroadway *impl;
   impl = CDK_WINDOW_IMPL_BROADWAY (window->impl);
+
+  /* Keep track of what was painted, so the daemon only has to
+   * look at that part of the surface. */
+  if (!impl->dirty)
+    impl->damage = cairo_region_copy (window->current_paint.region);
+  else if (impl->damage)
+    cairo_region_union (impl->damage, window->current_paint.region);
+
   impl->dirty = TRUE;
 }
 
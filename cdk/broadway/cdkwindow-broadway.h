@@ -50,7 +50,8 @@ struct _CdkWindowImplBroadway
   CdkScreen *screen;
 
   cairo_surface_t *surface;
-  cairo_surface_t *last_surface;
+  cairo_surface_t *last_surface; /* the previous frame, painted into next */
+  guint32 last_surface_serial; /* sync after which the daemon is done with it */
   cairo_surface_t *ref_surface;
 
   CdkCursor *cursor;
@@ -69,6 +70,7 @@ struct _CdkWindowImplBroadway
 
   gint8 toplevel_window_type;
   gboolean dirty;
+  cairo_region_t *damage; /* painted area while dirty, NULL means all */
   gboolean last_synced;
 
   CdkGeometry geometry_hints;
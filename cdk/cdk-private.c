@@ -22,7 +22,11 @@ cdk__private__ (void)
     cdk_get_desktop_autostart_id,
     cdk_profiler_is_running,
     cdk_profiler_start,
-    cdk_profiler_stop
+    cdk_profiler_stop,
+    cdk_profiler_define_int_counter,
+    cdk_profiler_set_int_counter,
+    cdk_profiler_add_mark,
+    cdk_event_get_history
   };
 
   return &table;
@@ -34,6 +34,9 @@ void             cdk_display_set_debug_updates (CdkDisplay *display,
 const gchar *   cdk_get_desktop_startup_id   (void);
 const gchar *   cdk_get_desktop_autostart_id (void);
 
+const CdkEventHistory * cdk_event_get_history (const CdkEvent *event,
+                                               guint          *n_entries);
+
 typedef struct {
   /* add all private functions here, initialize them in cdk-private.c */
   gboolean (* cdk_device_grab_info) (CdkDisplay  *display,
@@ -66,6 +69,19 @@ typedef struct {
   gboolean (* cdk_profiler_is_running) (void);
   void     (* cdk_profiler_start)      (int fd);
   void     (* cdk_profiler_stop)       (void);
+
+  guint    (* cdk_profiler_define_int_counter) (const char *name,
+                                                const char *description);
+  void     (* cdk_profiler_set_int_counter)    (guint       id,
+                                                gint64      time,
+                                                gint64      value);
+  void     (* cdk_profiler_add_mark)           (gint64      start,
+                                                guint64     duration,
+                                                const char *name,
+                                                const char *message);
+
+  const CdkEventHistory * (* cdk_event_get_history) (const CdkEvent *event,
+                                                     guint          *n_entries);
 } CdkPrivateVTable;
 
 CDK_AVAILABLE_IN_ALL
@@ -25,9 +25,11 @@
 #include "config.h"
 
 
+#include "cdk-private.h"
 #include "cdkinternals.h"
 #include "cdkdisplayprivate.h"
 #include "cdkdndprivate.h"
+#include "cdkprofilerprivate.h"
 
 #include <string.h>
 #include <math.h>
@@ -66,15 +68,39 @@ static CdkEventFunc   _cdk_event_func = NULL;    /* Callback for events */
 static gpointer       _cdk_event_data = NULL;
 static GDestroyNotify _cdk_event_notify = NULL;
 
+static const char *
+get_event_type_name (CdkEventType type)
+{
+  static GEnumClass *event_type_class = NULL;
+  GEnumValue *value;
+
+  if (event_type_class == NULL)
+    event_type_class = g_type_class_ref (CDK_TYPE_EVENT_TYPE);
+
+  value = g_enum_get_value (event_type_class, type);
+
+  return value ? value->value_nick : "";
+}
+
 void
 _cdk_event_emit (CdkEvent *event)
 {
+  gint64 before = 0;
+
   if (cdk_drag_context_handle_source_event (event))
     return;
 
+  if (cdk_profiler_is_running ())
+    before = g_get_monotonic_time ();
+
   if (_cdk_event_func)
     (*_cdk_event_func) (event, _cdk_event_data);
 
+  if (before != 0)
+    cdk_profiler_add_mark (before * 1000,
+                           (g_get_monotonic_time () - before) * 1000,
+                           "event dispatch", get_event_type_name (event->type));
+
   if (cdk_drag_context_handle_dest_event (event))
     return;
 }
@@ -83,6 +109,37 @@ _cdk_event_emit (CdkEvent *event)
  * Functions for maintaining the event queue *
  *********************************************/
 
+/* Whether @event is of a kind that only reports the current state of
+ * a device, so that a newer event of the same kind can stand in for it.
+ */
+static gboolean
+is_coalescable_event (CdkEventPrivate *event)
+{
+  if (event->flags & CDK_EVENT_PENDING)
+    return FALSE;
+
+  switch ((guint) event->event.type)
+    {
+    case CDK_MOTION_NOTIFY:
+    case CDK_TOUCH_UPDATE:
+    case CDK_PAD_RING:
+    case CDK_PAD_STRIP:
+      break;
+
+    case CDK_SCROLL:
+      if (event->event.scroll.direction != CDK_SCROLL_SMOOTH ||
+          event->event.scroll.is_stop)
+        return FALSE;
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  return event->event.any.window != NULL &&
+         event->event.any.window->event_compression;
+}
+
 /**
  * _cdk_event_queue_find_first:
  * @display: a #CdkDisplay
@@ -112,7 +169,8 @@ _cdk_event_queue_find_first (CdkDisplay *display)
           if (pending_motion)
             return pending_motion;
 
-          if (event->event.type == CDK_MOTION_NOTIFY && (event->flags & CDK_EVENT_FLUSHED) == 0)
+          if ((event->event.type == CDK_MOTION_NOTIFY || is_coalescable_event (event)) &&
+              (event->flags & CDK_EVENT_FLUSHED) == 0)
             pending_motion = tmp_list;
           else
             return tmp_list;
@@ -254,61 +312,150 @@ _cdk_event_unqueue (CdkDisplay *display)
   return event;
 }
 
-void
-_cdk_event_queue_handle_motion_compression (CdkDisplay *display)
+/* Whether @newer reports on the same thing as @older, so that @older
+ * may be merged into it.
+ */
+static gboolean
+event_supersedes (CdkEventPrivate *newer,
+                  CdkEventPrivate *older)
 {
-  GList *tmp_list;
-  GList *pending_motions = NULL;
-  CdkWindow *pending_motion_window = NULL;
-  CdkDevice *pending_motion_device = NULL;
+  CdkEvent *a = &newer->event, *b = &older->event;
 
-  /* If the last N events in the event queue are motion notify
-   * events for the same window, drop all but the last */
+  if (a->type != b->type ||
+      a->any.window != b->any.window)
+    return FALSE;
 
-  tmp_list = display->queued_tail;
+  switch ((guint) a->type)
+    {
+    case CDK_MOTION_NOTIFY:
+      return a->motion.device == b->motion.device;
 
-  while (tmp_list)
+    case CDK_SCROLL:
+      return a->scroll.device == b->scroll.device &&
+             a->scroll.state == b->scroll.state;
+
+    case CDK_TOUCH_UPDATE:
+      return a->touch.device == b->touch.device &&
+             a->touch.sequence == b->touch.sequence;
+
+    case CDK_PAD_RING:
+    case CDK_PAD_STRIP:
+      return newer->device == older->device &&
+             a->pad_axis.group == b->pad_axis.group &&
+             a->pad_axis.index == b->pad_axis.index;
+
+    default:
+      return FALSE;
+    }
+}
+
+static void
+append_history (GArray   *history,
+                CdkEvent *event)
+{
+  CdkEventHistory entry;
+
+  if (!cdk_event_get_coords (event, &entry.x, &entry.y))
+    return;
+
+  entry.time = cdk_event_get_time (event);
+  g_array_append_val (history, entry);
+}
+
+/* Folds @older into @newer, which is queued after it. Relative
+ * quantities are accumulated, and positions are kept as history
+ * so that velocity tracking does not lose samples.
+ */
+static void
+merge_events (CdkEventPrivate *newer,
+              CdkEventPrivate *older)
+{
+  if (newer->event.type == CDK_SCROLL)
     {
-      CdkEventPrivate *event = tmp_list->data;
+      newer->event.scroll.delta_x += older->event.scroll.delta_x;
+      newer->event.scroll.delta_y += older->event.scroll.delta_y;
+      return;
+    }
 
-      if (event->flags & CDK_EVENT_PENDING)
-        break;
+  if (newer->event.type != CDK_MOTION_NOTIFY &&
+      newer->event.type != CDK_TOUCH_UPDATE)
+    return;
 
-      if (event->event.type != CDK_MOTION_NOTIFY)
-        break;
+  if (older->history == NULL)
+    older->history = g_array_new (FALSE, FALSE, sizeof (CdkEventHistory));
 
-      if (pending_motion_window != NULL &&
-          pending_motion_window != event->event.motion.window)
-        break;
+  append_history (older->history, &older->event);
 
-      if (pending_motion_device != NULL &&
-          pending_motion_device != event->event.motion.device)
-        break;
+  if (newer->history)
+    {
+      g_array_append_vals (older->history,
+                           newer->history->data, newer->history->len);
+      g_array_unref (newer->history);
+    }
+
+  newer->history = g_steal_pointer (&older->history);
+}
+
+void
+_cdk_event_queue_handle_compression (CdkDisplay *display)
+{
+  GList *tmp_list;
+  GList *first = NULL;
+  CdkWindow *window = NULL;
+  CdkEventType type = CDK_NOTHING;
+
+  /* Look at the trailing run of coalescable events of one type for
+   * one window, and in it drop all but the last event for each device,
+   * touch sequence or pad control, folding the dropped ones into the
+   * one that is kept. The run is held back from dispatch until another
+   * event arrives or the frame clock flushes the queue.
+   */
 
-      if (!event->event.motion.window->event_compression)
+  for (tmp_list = display->queued_tail; tmp_list; tmp_list = tmp_list->prev)
+    {
+      CdkEventPrivate *event = tmp_list->data;
+
+      if (!is_coalescable_event (event))
         break;
 
-      pending_motion_window = event->event.motion.window;
-      pending_motion_device = event->event.motion.device;
-      pending_motions = tmp_list;
+      if (window != NULL &&
+          (window != event->event.any.window || type != event->event.type))
+        break;
 
-      tmp_list = tmp_list->prev;
+      window = event->event.any.window;
+      type = event->event.type;
+      first = tmp_list;
     }
 
-  while (pending_motions && pending_motions->next != NULL)
+  for (tmp_list = first; tmp_list && tmp_list->next; )
     {
-      GList *next = pending_motions->next;
-      cdk_event_free (pending_motions->data);
-      display->queued_events = g_list_delete_link (display->queued_events,
-                                                   pending_motions);
-      pending_motions = next;
+      GList *next = tmp_list->next;
+      GList *l;
+
+      for (l = next; l; l = l->next)
+        {
+          if (event_supersedes (l->data, tmp_list->data))
+            {
+              merge_events (l->data, tmp_list->data);
+              cdk_event_free (tmp_list->data);
+              if (tmp_list == first)
+                first = next;
+              _cdk_event_queue_remove_link (display, tmp_list);
+              g_list_free_1 (tmp_list);
+              break;
+            }
+        }
+
+      tmp_list = next;
     }
 
-  if (pending_motions &&
-      pending_motions == display->queued_events &&
-      pending_motions == display->queued_tail)
+  /* The last event of the run stays queued until something else
+   * arrives, which may take a while when other events are ahead of
+   * it, so always have the frame clock flush it.
+   */
+  if (first)
     {
-      CdkFrameClock *clock = cdk_window_get_frame_clock (pending_motion_window);
+      CdkFrameClock *clock = cdk_window_get_frame_clock (window);
       if (clock) /* might be NULL if window was destroyed */
 	cdk_frame_clock_request_phase (clock, CDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS);
     }
@@ -632,6 +779,28 @@ cdk_event_get_pointer_emulated (CdkEvent *event)
   return FALSE;
 }
 
+/* Returns the positions that were coalesced into @event by event
+ * compression, oldest first, in the coordinates of the event's window.
+ */
+const CdkEventHistory *
+cdk_event_get_history (const CdkEvent *event,
+                       guint          *n_entries)
+{
+  CdkEventPrivate *private;
+
+  *n_entries = 0;
+
+  if (!cdk_event_is_allocated (event))
+    return NULL;
+
+  private = (CdkEventPrivate *) event;
+  if (private->history == NULL)
+    return NULL;
+
+  *n_entries = private->history->len;
+  return (const CdkEventHistory *) private->history->data;
+}
+
 /**
  * cdk_event_copy:
  * @event: a #CdkEvent
@@ -667,6 +836,14 @@ cdk_event_copy (const CdkEvent *event)
       new_private->seat = private->seat;
       new_private->tool = private->tool;
 
+      if (private->history)
+        {
+          new_private->history = g_array_sized_new (FALSE, FALSE, sizeof (CdkEventHistory),
+                                                    private->history->len);
+          g_array_append_vals (new_private->history,
+                               private->history->data, private->history->len);
+        }
+
 #ifdef CDK_WINDOWING_WIN32
       new_private->translation_len = private->translation_len;
       new_private->translation = g_memdup2 (private->translation, private->translation_len * sizeof (private->translation[0]));
@@ -775,6 +952,7 @@ cdk_event_free (CdkEvent *event)
       private = (CdkEventPrivate *) event;
       g_clear_object (&private->device);
       g_clear_object (&private->source_device);
+      g_clear_pointer (&private->history, g_array_unref);
 #ifdef CDK_WINDOWING_WIN32
       g_free (private->translation);
 #endif
@@ -93,6 +93,8 @@ struct _CdkFrameClockPrivate
   gint n_timings;
   gint current;
   CdkFrameTimings *timings[FRAME_HISTORY_MAX_LENGTH];
+
+  gint64 refresh_interval; /* Of the monitor the window is on, 0 if unknown */
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (CdkFrameClock, cdk_frame_clock, G_TYPE_OBJECT)
@@ -549,6 +551,45 @@ _cdk_frame_clock_debug_print_timings (CdkFrameClock   *clock,
 #define DEFAULT_REFRESH_INTERVAL 16667 /* 16.7ms (1/60th second) */
 #define MAX_HISTORY_AGE 150000         /* 150ms */
 
+/*< private >
+ * _cdk_frame_clock_set_refresh_interval:
+ * @frame_clock: a #CdkFrameClock
+ * @refresh_interval: the refresh interval of the monitor the clock's
+ *   window is on, in microseconds, or 0 if unknown
+ *
+ * Sets the refresh interval the frame clock assumes when the backend
+ * doesn't report one in the frame timings.
+ */
+void
+_cdk_frame_clock_set_refresh_interval (CdkFrameClock *frame_clock,
+                                       gint64         refresh_interval)
+{
+  g_return_if_fail (CDK_IS_FRAME_CLOCK (frame_clock));
+
+  frame_clock->priv->refresh_interval = refresh_interval;
+}
+
+/*< private >
+ * _cdk_frame_clock_get_refresh_interval:
+ * @frame_clock: a #CdkFrameClock
+ *
+ * Returns the refresh interval set with
+ * _cdk_frame_clock_set_refresh_interval(), or 1/60th of a second
+ * if none is known.
+ *
+ * Returns: the nominal refresh interval, in microseconds
+ */
+gint64
+_cdk_frame_clock_get_refresh_interval (CdkFrameClock *frame_clock)
+{
+  g_return_val_if_fail (CDK_IS_FRAME_CLOCK (frame_clock), DEFAULT_REFRESH_INTERVAL);
+
+  if (frame_clock->priv->refresh_interval == 0)
+    return DEFAULT_REFRESH_INTERVAL;
+
+  return frame_clock->priv->refresh_interval;
+}
+
 /**
  * cdk_frame_clock_get_refresh_info:
  * @frame_clock: a #CdkFrameClock
@@ -575,7 +616,7 @@ cdk_frame_clock_get_refresh_info (CdkFrameClock *frame_clock,
                                   gint64        *presentation_time_return)
 {
   gint64 frame_counter;
-  gint64 default_refresh_interval = DEFAULT_REFRESH_INTERVAL;
+  gint64 default_refresh_interval = _cdk_frame_clock_get_refresh_interval (frame_clock);
 
   g_return_if_fail (CDK_IS_FRAME_CLOCK (frame_clock));
 
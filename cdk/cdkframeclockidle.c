@@ -30,12 +30,40 @@
 #include "cdkprofilerprivate.h"
 #include "cdk.h"
 
+#include <string.h>
+
 #ifdef G_OS_WIN32
 #include <windows.h>
 #endif
 
 #define FRAME_INTERVAL 16667 /* microseconds */
 
+/* How many of the most recent clock cycles to look at for predicting
+ * how long the next one will take
+ */
+#define N_CYCLE_DURATIONS 16
+
+/* The least time to leave between the predicted end of a late started
+ * clock cycle and the vblank, in microseconds
+ */
+#define LATE_START_MIN_MARGIN 2000
+
+/* How many clock cycles to start right away after a frame was
+ * presented later than predicted
+ */
+#define LATE_START_BACKOFF 120
+
+/* How many late started frames in a row have to be presented on time
+ * before the margin left for the compositor is halved again
+ */
+#define LATE_START_DECAY 60
+
+typedef struct {
+  gint64 frame_counter;
+  gint64 target;       /* The vblank the cycle was aimed at, 0 if unknown */
+  gboolean late;       /* Whether the cycle was started late */
+} CycleTarget;
+
 typedef enum {
   SMOOTH_PHASE_STATE_VALID = 0,    /* explicit, since we count on zero-init */
   SMOOTH_PHASE_STATE_AWAIT_FIRST,
@@ -55,6 +83,15 @@ struct _CdkFrameClockIdlePrivate
                                           the initial value of smooth_phase_state is SMOOTH_PHASE_STATE_VALID. See the comment in cdk_frame_clock_paint_idle()
                                           for details. */
 
+  gint64 cycle_durations[N_CYCLE_DURATIONS]; /* How long the most recent complete clock cycles took, 0 if unknown */
+  guint cycle_duration_index;          /* Where in cycle_durations the next duration goes */
+  CycleTarget cycle_targets[N_CYCLE_DURATIONS]; /* The vblanks the most recent complete clock cycles were aimed at */
+  guint late_start_backoff;            /* Clock cycles to wait before starting late again after a missed frame */
+  gint64 late_start_target;            /* The vblank the next clock cycle is aimed at, if it is started late */
+  gint64 late_start_margin;            /* Time to leave for the compositor before the vblank, grows with missed frames and shrinks with frames on time */
+  gint64 late_start_checked;           /* The frame counter of the last late started cycle checked for a miss */
+  guint late_start_hits;               /* Late started cycles presented on time since the last miss or decay */
+
   gint64 sleep_serial;
 #ifdef G_ENABLE_DEBUG
   gint64 freeze_time;
@@ -399,6 +436,7 @@ cdk_frame_clock_paint_idle (void *data)
   CdkFrameClockIdle *clock_idle = CDK_FRAME_CLOCK_IDLE (clock);
   CdkFrameClockIdlePrivate *priv = clock_idle->priv;
   gboolean skip_to_resume_events;
+  gboolean cycle_started = FALSE;
   CdkFrameTimings *timings = NULL;
 
   priv->paint_idle_id = 0;
@@ -424,13 +462,14 @@ cdk_frame_clock_paint_idle (void *data)
         case CDK_FRAME_CLOCK_PHASE_BEFORE_PAINT:
           if (priv->freeze_count == 0)
             {
-              gint64 frame_interval = FRAME_INTERVAL;
+              gint64 frame_interval = _cdk_frame_clock_get_refresh_interval (clock);
               CdkFrameTimings *prev_timings = cdk_frame_clock_get_current_timings (clock);
 
               if (prev_timings && prev_timings->refresh_interval)
                 frame_interval = prev_timings->refresh_interval;
 
               priv->frame_time = g_get_monotonic_time ();
+              cycle_started = TRUE;
 
               /*
                * The first clock cycle of an animation might have been triggered by some external event. An external
@@ -606,6 +645,28 @@ cdk_frame_clock_paint_idle (void *data)
                */
               priv->phase = CDK_FRAME_CLOCK_PHASE_NONE;
 
+              if (cycle_started)
+                {
+                  CycleTarget *target = &priv->cycle_targets[priv->cycle_duration_index];
+                  gint64 now = g_get_monotonic_time ();
+
+                  priv->cycle_durations[priv->cycle_duration_index] =
+                    MAX (now - priv->frame_time, 1);
+
+                  /* A cycle that was started right away aims at the first
+                   * vblank after it ends.
+                   */
+                  target->frame_counter = cdk_frame_clock_get_frame_counter (clock);
+                  target->late = priv->late_start_target != 0;
+                  if (target->late)
+                    target->target = priv->late_start_target;
+                  else
+                    cdk_frame_clock_get_refresh_info (clock, now, NULL, &target->target);
+                  priv->late_start_target = 0;
+
+                  priv->cycle_duration_index = (priv->cycle_duration_index + 1) % N_CYCLE_DURATIONS;
+                }
+
 #ifdef G_ENABLE_DEBUG
               if (CDK_DEBUG_CHECK (FRAMES) || cdk_profiler_is_running ())
                 timings->frame_end_time = g_get_monotonic_time ();
@@ -664,6 +725,190 @@ cdk_frame_clock_paint_idle (void *data)
   return FALSE;
 }
 
+/* Late starts are opt-in until the miss detection has been checked
+ * against more compositors.
+ */
+static gboolean
+late_start_enabled (void)
+{
+  static gsize enabled = 0;
+
+  if (g_once_init_enter (&enabled))
+    {
+      gboolean value;
+
+      value = g_strcmp0 (g_getenv ("CDK_FRAME_CLOCK_LATE_START"), "1") == 0;
+      g_once_init_leave (&enabled, value ? 2 : 1);
+    }
+
+  return enabled == 2;
+}
+
+/* How many refresh cycles after the vblank it was aimed at the cycle
+ * for @target was presented, or -1 if it isn't known yet.
+ */
+static gint64
+get_presentation_delay (CdkFrameClock     *clock,
+                        const CycleTarget *target)
+{
+  CdkFrameTimings *timings;
+
+  if (target->target == 0)
+    return -1;
+
+  timings = cdk_frame_clock_get_timings (clock, target->frame_counter);
+  if (timings == NULL || !timings->complete ||
+      timings->presentation_time == 0 || timings->refresh_interval == 0)
+    return -1;
+
+  return MAX (timings->presentation_time - target->target + timings->refresh_interval / 2, 0) /
+         timings->refresh_interval;
+}
+
+/* Finds the most recent late started cycle that was presented, and
+ * whether it took longer to reach the screen than the cycles that were
+ * started right away, which means that it missed the vblank it was
+ * aimed at. Returns its frame counter, or 0 if there is none.
+ *
+ * Comparing with cycles started right away takes care of compositors
+ * that show frames one or more refresh cycles after the vblank they
+ * were committed for, which predicted presentation times account for
+ * in different ways on each backend.
+ */
+static gint64
+get_last_late_frame (CdkFrameClockIdle *clock_idle,
+                     gboolean          *missed)
+{
+  CdkFrameClock *clock = CDK_FRAME_CLOCK (clock_idle);
+  CdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 late_counter, late_delay, usual_delay;
+  int i;
+
+  late_counter = 0;
+  late_delay = -1;
+  usual_delay = G_MAXINT64;
+
+  for (i = 0; i < N_CYCLE_DURATIONS; i++)
+    {
+      const CycleTarget *target = &priv->cycle_targets[i];
+      gint64 delay;
+
+      delay = get_presentation_delay (clock, target);
+      if (delay < 0)
+        continue;
+
+      if (!target->late)
+        usual_delay = MIN (usual_delay, delay);
+      else if (target->frame_counter > late_counter)
+        {
+          late_counter = target->frame_counter;
+          late_delay = delay;
+        }
+    }
+
+  /* Without a frame started right away to compare with, assume that
+   * the compositor shows frames at the vblank they were committed for.
+   */
+  if (usual_delay == G_MAXINT64)
+    usual_delay = 0;
+
+  *missed = late_delay > usual_delay;
+
+  return late_counter;
+}
+
+/* When a clock cycle gets unblocked because the previous frame was
+ * drawn, there is usually most of a refresh cycle left before the next
+ * frame can make it to the screen. Starting the cycle as late as we can
+ * while still finishing before the next vblank means that input arriving
+ * in the meantime makes it into that frame instead of the one after.
+ *
+ * Returns the time at which to start the next clock cycle, or 0 if it
+ * should start right away.
+ */
+static gint64
+compute_late_start_time (CdkFrameClockIdle *clock_idle)
+{
+  CdkFrameClock *clock = CDK_FRAME_CLOCK (clock_idle);
+  CdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 now;
+  gint64 refresh_interval;
+  gint64 presentation_time;
+  gint64 budget;
+  gint64 late_counter;
+  gboolean missed;
+  int i;
+
+  if (!late_start_enabled ())
+    return 0;
+
+  if (priv->late_start_margin == 0)
+    priv->late_start_margin = LATE_START_MIN_MARGIN;
+
+  /* Missing a vblank usually means the compositor wants frames earlier
+   * than we thought, so leave it more time from now on. Once frames
+   * keep making it, the extra time is given back bit by bit.
+   */
+  late_counter = get_last_late_frame (clock_idle, &missed);
+  if (late_counter > priv->late_start_checked)
+    {
+      priv->late_start_checked = late_counter;
+
+      if (missed)
+        {
+          priv->late_start_backoff = LATE_START_BACKOFF;
+          priv->late_start_margin = MIN (priv->late_start_margin * 2, G_USEC_PER_SEC / 10);
+          priv->late_start_hits = 0;
+          memset (priv->cycle_targets, 0, sizeof (priv->cycle_targets));
+        }
+      else if (++priv->late_start_hits >= LATE_START_DECAY)
+        {
+          priv->late_start_margin = MAX (priv->late_start_margin / 2, LATE_START_MIN_MARGIN);
+          priv->late_start_hits = 0;
+        }
+    }
+
+  if (priv->late_start_backoff > 0)
+    {
+      priv->late_start_backoff--;
+      return 0;
+    }
+
+  /* Budget for the slowest of the recent cycles */
+  budget = 0;
+  for (i = 0; i < N_CYCLE_DURATIONS; i++)
+    {
+      if (priv->cycle_durations[i] == 0)
+        return 0;
+
+      budget = MAX (budget, priv->cycle_durations[i]);
+    }
+
+  now = g_get_monotonic_time ();
+  cdk_frame_clock_get_refresh_info (clock, now,
+                                    &refresh_interval, &presentation_time);
+
+  /* Without presentation times from the backend, we don't know where
+   * the vblank is.
+   */
+  if (presentation_time == 0)
+    return 0;
+
+  /* The cycle durations only cover our own work. Leave some room for
+   * mispredictions, and for the compositor, whose repaint deadline can
+   * be well before the vblank; the margin grows each time a late
+   * started frame misses.
+   */
+  budget += budget / 4 + CLAMP (priv->late_start_margin, refresh_interval / 4, refresh_interval);
+
+  if (presentation_time - budget <= now)
+    return 0;
+
+  priv->late_start_target = presentation_time;
+
+  return presentation_time - budget;
+}
+
 static void
 cdk_frame_clock_idle_request_phase (CdkFrameClock      *clock,
                                     CdkFrameClockPhase  phase)
@@ -753,13 +998,19 @@ cdk_frame_clock_idle_thaw (CdkFrameClock *clock)
   priv->freeze_count--;
   if (priv->freeze_count == 0)
     {
+      priv->min_next_frame_time = MAX (priv->min_next_frame_time,
+                                       compute_late_start_time (clock_idle));
+
       maybe_start_idle (clock_idle, TRUE);
       /* If nothing is requested so we didn't start an idle, we need
        * to skip to the end of the state chain, since the idle won't
        * run and do it for us.
        */
       if (priv->paint_idle_id == 0)
-        priv->phase = CDK_FRAME_CLOCK_PHASE_NONE;
+        {
+          priv->phase = CDK_FRAME_CLOCK_PHASE_NONE;
+          priv->late_start_target = 0;
+        }
 
       priv->sleep_serial = get_sleep_serial ();
 
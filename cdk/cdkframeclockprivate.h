@@ -108,6 +108,10 @@ struct _CdkFrameTimings
 void _cdk_frame_clock_freeze (CdkFrameClock *clock);
 void _cdk_frame_clock_thaw   (CdkFrameClock *clock);
 
+void   _cdk_frame_clock_set_refresh_interval (CdkFrameClock *clock,
+                                              gint64         refresh_interval);
+gint64 _cdk_frame_clock_get_refresh_interval (CdkFrameClock *clock);
+
 void _cdk_frame_clock_begin_frame         (CdkFrameClock   *clock);
 void _cdk_frame_clock_debug_print_timings (CdkFrameClock   *clock,
                                            CdkFrameTimings *timings);
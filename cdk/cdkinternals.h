@@ -181,6 +181,14 @@ typedef enum
   CDK_EVENT_FLUSHED = 1 << 2
 } CdkEventFlags;
 
+/* A position that an event was coalesced over, oldest first */
+typedef struct
+{
+  guint32 time;
+  gdouble x;
+  gdouble y;
+} CdkEventHistory;
+
 struct _CdkEventPrivate
 {
   CdkEvent   event;
@@ -192,6 +200,7 @@ struct _CdkEventPrivate
   CdkSeat   *seat;
   CdkDeviceTool *tool;
   guint16    key_scancode;
+  GArray    *history;
 
 #ifdef CDK_WINDOWING_WIN32
   gunichar2 *translation;
@@ -201,6 +210,11 @@ struct _CdkEventPrivate
 
 typedef struct _CdkWindowPaint CdkWindowPaint;
 
+/* The oldest back buffer that is brought up to date from the areas
+ * updated since, rather than by repainting the whole window
+ */
+#define CDK_WINDOW_MAX_BUFFER_AGE 4
+
 struct _CdkWindow
 {
   GObject parent_instance;
@@ -322,7 +336,7 @@ struct _CdkWindow
      more than we have to, but it represents the "true" damage. */
   cairo_region_t *active_update_area;
   /* We store the old expose areas to support buffer-age optimizations */
-  cairo_region_t *old_updated_area[2];
+  cairo_region_t *old_updated_area[CDK_WINDOW_MAX_BUFFER_AGE - 1];
 
   CdkWindowState old_state;
   CdkWindowState state;
@@ -435,7 +449,7 @@ GList* _cdk_event_queue_insert_before(CdkDisplay *display,
                                       CdkEvent   *after_event,
                                       CdkEvent   *event);
 
-void    _cdk_event_queue_handle_motion_compression (CdkDisplay *display);
+void    _cdk_event_queue_handle_compression        (CdkDisplay *display);
 void    _cdk_event_queue_flush                     (CdkDisplay       *display);
 
 void   _cdk_event_button_generate    (CdkDisplay *display,
@@ -482,6 +496,10 @@ void       _cdk_window_destroy           (CdkWindow      *window,
                                           gboolean        foreign_destroy);
 void       _cdk_window_clear_update_area (CdkWindow      *window);
 void       _cdk_window_update_size       (CdkWindow      *window);
+void       _cdk_window_update_frame_clock_monitor (CdkWindow *window);
+gboolean   _cdk_window_add_buffer_age_damage (CdkWindow      *window,
+                                              cairo_region_t *update_area,
+                                              int             buffer_age);
 gboolean   _cdk_window_update_viewable   (CdkWindow      *window);
 CdkGLContext * cdk_window_get_paint_gl_context (CdkWindow *window,
                                                 GError   **error);
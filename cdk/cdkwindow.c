@@ -1147,9 +1147,9 @@ recompute_visible_regions (CdkWindow *private,
 static void
 cdk_window_clear_old_updated_area (CdkWindow *window)
 {
-  int i;
+  guint i;
 
-  for (i = 0; i < 2; i++)
+  for (i = 0; i < G_N_ELEMENTS (window->old_updated_area); i++)
     {
       if (window->old_updated_area[i])
         {
@@ -1163,12 +1163,51 @@ static void
 cdk_window_append_old_updated_area (CdkWindow *window,
                                     cairo_region_t *region)
 {
-  if (window->old_updated_area[1])
-    cairo_region_destroy (window->old_updated_area[1]);
-  window->old_updated_area[1] = window->old_updated_area[0];
+  guint i;
+
+  i = G_N_ELEMENTS (window->old_updated_area) - 1;
+  if (window->old_updated_area[i])
+    cairo_region_destroy (window->old_updated_area[i]);
+  for (; i > 0; i--)
+    window->old_updated_area[i] = window->old_updated_area[i - 1];
   window->old_updated_area[0] = cairo_region_reference (region);
 }
 
+/*< private >
+ * _cdk_window_add_buffer_age_damage:
+ * @window: a #CdkWindow
+ * @update_area: the region that is about to be repainted
+ * @buffer_age: the age of the buffer that will be drawn to, 1 if it
+ *   holds the previous frame, 2 if the one before that, and so on
+ *
+ * Adds the areas updated since the buffer was last drawn to to
+ * @update_area, so that it is brought up to date by the next paint.
+ *
+ * Returns: %FALSE if the buffer age is unknown or too old to be
+ *   handled, in which case the whole window must be repainted
+ */
+gboolean
+_cdk_window_add_buffer_age_damage (CdkWindow      *window,
+                                   cairo_region_t *update_area,
+                                   int             buffer_age)
+{
+  int i;
+
+  if (buffer_age <= 0 || buffer_age > CDK_WINDOW_MAX_BUFFER_AGE)
+    return FALSE;
+
+  for (i = 0; i < buffer_age - 1; i++)
+    {
+      if (window->old_updated_area[i] == NULL)
+        return FALSE;
+    }
+
+  for (i = 0; i < buffer_age - 1; i++)
+    cairo_region_union (update_area, window->old_updated_area[i]);
+
+  return TRUE;
+}
+
 void
 _cdk_window_update_size (CdkWindow *window)
 {
@@ -9956,6 +9995,12 @@ _cdk_windowing_got_event (CdkDisplay *display,
       goto out;
     }
 
+  if (event->type == CDK_CONFIGURE || event->type == CDK_MAP)
+    {
+      _cdk_window_update_frame_clock_monitor (event_window);
+      goto out;
+    }
+
   if (!(event->type == CDK_TOUCH_CANCEL ||
         is_button_type (event->type) ||
         is_motion_type (event->type) ||
@@ -10099,12 +10144,13 @@ _cdk_windowing_got_event (CdkDisplay *display,
       cdk_event_free (event);
     }
 
-  /* This does two things - first it sees if there are motions at the
-   * end of the queue that can be compressed. Second, if there is just
-   * a single motion that won't be dispatched because it is a compression
-   * candidate it queues up flushing the event queue.
+  /* This does two things - first it sees if there are motions, scrolls
+   * or touch updates at the end of the queue that can be coalesced.
+   * Second, if there is just a single such event that won't be dispatched
+   * because it is a compression candidate it queues up flushing the
+   * event queue.
    */
-  _cdk_event_queue_handle_motion_compression (display);
+  _cdk_event_queue_handle_compression (display);
 }
 
 /**
@@ -10652,6 +10698,10 @@ cdk_window_set_focus_on_map (CdkWindow *window,
  * the event queue can be discarded. If %TRUE only the most recent
  * event will be delivered.
  *
+ * This also applies to smooth scroll events, whose deltas are summed
+ * up, to touch updates of the same touch sequence and to ring and
+ * strip events of tablet pads.
+ *
  * Some types of applications, e.g. paint programs, need to see all
  * motion events and will benefit from turning off event compression.
  *
@@ -11771,6 +11821,48 @@ cdk_window_set_frame_clock (CdkWindow     *window,
   window->frame_clock = clock;
 }
 
+/*< private >
+ * _cdk_window_update_frame_clock_monitor:
+ * @window: a toplevel #CdkWindow
+ *
+ * Makes the frame clock of @window assume the refresh rate of the
+ * monitor the window is mostly on, for when the backend doesn't know
+ * when frames are drawn. Backends call this when windows may have
+ * moved to a different monitor.
+ */
+void
+_cdk_window_update_frame_clock_monitor (CdkWindow *window)
+{
+  CdkDisplay *display;
+  CdkDisplayClass *display_class;
+  CdkMonitor *monitor;
+  int refresh_rate;
+
+  if (window->frame_clock == NULL || CDK_WINDOW_DESTROYED (window))
+    return;
+
+  display = cdk_window_get_display (window);
+  display_class = CDK_DISPLAY_GET_CLASS (display);
+
+  /* Avoid cdk_display_get_monitor_at_window(), which needs a roundtrip
+   * to find the window position on some backends; the cached position
+   * is good enough here.
+   */
+  monitor = NULL;
+  if (display_class->get_monitor_at_window)
+    monitor = display_class->get_monitor_at_window (display, window);
+  if (monitor == NULL)
+    monitor = cdk_display_get_monitor_at_point (display,
+                                                window->x + window->width / 2,
+                                                window->y + window->height / 2);
+
+  refresh_rate = monitor ? cdk_monitor_get_refresh_rate (monitor) : 0;
+
+  /* The refresh rate is in milli-Hertz */
+  _cdk_frame_clock_set_refresh_interval (window->frame_clock,
+                                         refresh_rate > 0 ? G_GINT64_CONSTANT (1000000000) / refresh_rate : 0);
+}
+
 /**
  * cdk_window_get_frame_clock:
  * @window: window to get frame clock for
@@ -22,6 +22,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
 
 #ifdef HAVE_LINUX_MEMFD_H
 #include <linux/memfd.h>
@@ -87,6 +88,7 @@
 #define CTK_SHELL1_VERSION       3
 
 static void _cdk_wayland_display_load_cursor_theme (CdkWaylandDisplay *display_wayland);
+static void cdk_wayland_shm_pool_free (gpointer data);
 
 G_DEFINE_TYPE (CdkWaylandDisplay, cdk_wayland_display, CDK_TYPE_DISPLAY)
 
@@ -374,6 +376,23 @@ static const struct org_kde_kwin_server_decoration_manager_listener server_decor
   .default_mode = server_decoration_manager_default_mode
 };
 
+static void
+presentation_handle_clock_id (void                   *data,
+                              struct wp_presentation *presentation,
+                              uint32_t                clk_id)
+{
+  CdkWaylandDisplay *display_wayland = data;
+
+  /* Presentation times are only useful to us if they can be compared
+   * with g_get_monotonic_time()
+   */
+  display_wayland->presentation_clock_is_monotonic = clk_id == CLOCK_MONOTONIC;
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+  presentation_handle_clock_id
+};
+
 gboolean
 cdk_wayland_display_prefers_ssd (CdkDisplay *display)
 {
@@ -530,6 +549,16 @@ cdk_registry_handle_global (void               *data,
       _cdk_wayland_screen_init_xdg_output (display_wayland->screen);
       _cdk_wayland_display_async_roundtrip (display_wayland);
     }
+  else if (strcmp (interface, "wp_presentation") == 0)
+    {
+      display_wayland->presentation_id = id;
+      display_wayland->presentation =
+        wl_registry_bind (display_wayland->wl_registry, id,
+                          &wp_presentation_interface, 1);
+      wp_presentation_add_listener (display_wayland->presentation,
+                                    &presentation_listener,
+                                    display_wayland);
+    }
 
   g_hash_table_insert (display_wayland->known_globals,
                        GUINT_TO_POINTER (id), g_strdup (interface));
@@ -549,6 +578,13 @@ cdk_registry_handle_global_remove (void               *data,
   _cdk_wayland_device_manager_remove_seat (display->device_manager, id);
   _cdk_wayland_screen_remove_output (display_wayland->screen, id);
 
+  if (display_wayland->presentation && id == display_wayland->presentation_id)
+    {
+      /* Frames go back to being completed by their frame callbacks */
+      g_clear_pointer (&display_wayland->presentation, wp_presentation_destroy);
+      display_wayland->presentation_clock_is_monotonic = FALSE;
+    }
+
   g_hash_table_remove (display_wayland->known_globals, GUINT_TO_POINTER (id));
 
   /* FIXME: the object needs to be destroyed here, we're leaking */
@@ -699,6 +735,8 @@ cdk_wayland_display_dispose (GObject *object)
 
   g_list_free_full (display_wayland->async_roundtrips, (GDestroyNotify) wl_callback_destroy);
 
+  g_clear_pointer (&display_wayland->presentation, wp_presentation_destroy);
+
   if (display_wayland->known_globals)
     {
       g_hash_table_destroy (display_wayland->known_globals);
@@ -735,6 +773,9 @@ cdk_wayland_display_finalize (GObject *object)
 
   g_ptr_array_free (display_wayland->monitors, TRUE);
 
+  g_list_free_full (display_wayland->free_shm_pools, cdk_wayland_shm_pool_free);
+  display_wayland->free_shm_pools = NULL;
+
   wl_display_disconnect(display_wayland->wl_display);
 
   G_OBJECT_CLASS (cdk_wayland_display_parent_class)->finalize (object);
@@ -1246,10 +1287,22 @@ cdk_wayland_display_get_wl_compositor (CdkDisplay *display)
 
 static const cairo_user_data_key_t cdk_wayland_shm_surface_cairo_key;
 
-typedef struct _CdkWaylandCairoSurfaceData {
+/* A mapped shared memory segment and the wl_shm_pool for it. Creating
+ * one takes several syscalls and a roundtrip through the compositor's
+ * mmap, so the pools of destroyed window buffers are kept around and
+ * new buffers of a similar size are carved out of them.
+ */
+typedef struct _CdkWaylandShmPool {
   gpointer buf;
   size_t buf_length;
   struct wl_shm_pool *pool;
+} CdkWaylandShmPool;
+
+/* How many unused pools to keep per display */
+#define MAX_FREE_SHM_POOLS 4
+
+typedef struct _CdkWaylandCairoSurfaceData {
+  CdkWaylandShmPool *shm_pool;
   struct wl_buffer *buffer;
   CdkWaylandDisplay *display;
   uint32_t scale;
@@ -1309,7 +1362,7 @@ open_shared_memory (void)
 
 static struct wl_shm_pool *
 create_shm_pool (struct wl_shm  *shm,
-                 int             size,
+                 size_t          size,
                  size_t         *buf_length,
                  void          **data_out)
 {
@@ -1348,6 +1401,80 @@ create_shm_pool (struct wl_shm  *shm,
   return pool;
 }
 
+static void
+cdk_wayland_shm_pool_free (gpointer data)
+{
+  CdkWaylandShmPool *shm_pool = data;
+
+  if (shm_pool->pool)
+    wl_shm_pool_destroy (shm_pool->pool);
+
+  munmap (shm_pool->buf, shm_pool->buf_length);
+  g_free (shm_pool);
+}
+
+/* Returns a pool of at least @size bytes, reusing a free one if
+ * there is one that is not much bigger than needed.
+ */
+static CdkWaylandShmPool *
+cdk_wayland_display_get_shm_pool (CdkWaylandDisplay *display,
+                                  size_t             size)
+{
+  CdkWaylandShmPool *shm_pool;
+  size_t alloc_size;
+  long page_size;
+  GList *l;
+
+  for (l = display->free_shm_pools; l; l = l->next)
+    {
+      shm_pool = l->data;
+
+      if (shm_pool->buf_length >= size && shm_pool->buf_length / 2 <= size)
+        {
+          display->free_shm_pools = g_list_delete_link (display->free_shm_pools, l);
+          return shm_pool;
+        }
+    }
+
+  /* Leave room for growing, so that interactive resizes can keep
+   * using the same pool for a while.
+   */
+  page_size = sysconf (_SC_PAGESIZE);
+  if (page_size <= 0)
+    page_size = 4096;
+  alloc_size = size + size / 4;
+  alloc_size = (alloc_size + page_size - 1) / page_size * page_size;
+
+  shm_pool = g_new0 (CdkWaylandShmPool, 1);
+  shm_pool->pool = create_shm_pool (display->shm,
+                                    alloc_size,
+                                    &shm_pool->buf_length,
+                                    &shm_pool->buf);
+  if (shm_pool->pool == NULL)
+    {
+      g_free (shm_pool);
+      return NULL;
+    }
+
+  return shm_pool;
+}
+
+static void
+cdk_wayland_display_release_shm_pool (CdkWaylandDisplay *display,
+                                      CdkWaylandShmPool *shm_pool)
+{
+  GList *last;
+
+  display->free_shm_pools = g_list_prepend (display->free_shm_pools, shm_pool);
+
+  if (g_list_length (display->free_shm_pools) > MAX_FREE_SHM_POOLS)
+    {
+      last = g_list_last (display->free_shm_pools);
+      cdk_wayland_shm_pool_free (last->data);
+      display->free_shm_pools = g_list_delete_link (display->free_shm_pools, last);
+    }
+}
+
 static void
 cdk_wayland_cairo_surface_destroy (void *p)
 {
@@ -1356,10 +1483,9 @@ cdk_wayland_cairo_surface_destroy (void *p)
   if (data->buffer)
     wl_buffer_destroy (data->buffer);
 
-  if (data->pool)
-    wl_shm_pool_destroy (data->pool);
+  if (data->shm_pool)
+    cdk_wayland_display_release_shm_pool (data->display, data->shm_pool);
 
-  munmap (data->buf, data->buf_length);
   g_free (data);
 }
 
@@ -1381,20 +1507,19 @@ _cdk_wayland_display_create_shm_surface (CdkWaylandDisplay *display,
 
   stride = cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width*scale);
 
-  data->pool = create_shm_pool (display->shm,
-                                height*scale*stride,
-                                &data->buf_length,
-                                &data->buf);
+  data->shm_pool = cdk_wayland_display_get_shm_pool (display,
+                                                     (size_t) height*scale*stride);
 
-  surface = cairo_image_surface_create_for_data (data->buf,
+  surface = cairo_image_surface_create_for_data (data->shm_pool ? data->shm_pool->buf : NULL,
                                                  CAIRO_FORMAT_ARGB32,
                                                  width*scale,
                                                  height*scale,
                                                  stride);
 
-  data->buffer = wl_shm_pool_create_buffer (data->pool, 0,
-                                            width*scale, height*scale,
-                                            stride, WL_SHM_FORMAT_ARGB8888);
+  if (data->shm_pool)
+    data->buffer = wl_shm_pool_create_buffer (data->shm_pool->pool, 0,
+                                              width*scale, height*scale,
+                                              stride, WL_SHM_FORMAT_ARGB8888);
 
   cairo_surface_set_user_data (surface, &cdk_wayland_shm_surface_cairo_key,
                                data, cdk_wayland_cairo_surface_destroy);
@@ -36,6 +36,7 @@
 #include <cdk/wayland/server-decoration-client-protocol.h>
 #include <cdk/wayland/xdg-output-unstable-v1-client-protocol.h>
 #include <cdk/wayland/primary-selection-unstable-v1-client-protocol.h>
+#include <cdk/wayland/presentation-time-client-protocol.h>
 
 #include <glib.h>
 #include <cdk/cdkkeys.h>
@@ -98,6 +99,9 @@ struct _CdkWaylandDisplay
   struct org_kde_kwin_server_decoration_manager *server_decoration_manager;
   struct zxdg_output_manager_v1 *xdg_output_manager;
   uint32_t xdg_output_version;
+  struct wp_presentation *presentation;
+  uint32_t presentation_id;
+  gboolean presentation_clock_is_monotonic;
 
   GList *async_roundtrips;
 
@@ -113,6 +117,9 @@ struct _CdkWaylandDisplay
 
   GList *current_popups;
 
+  /* Shared memory pools of released window buffers, for reuse */
+  GList *free_shm_pools;
+
   struct wl_cursor_theme *scaled_cursor_themes[CDK_WAYLAND_THEME_SCALES_COUNT];
   gchar *cursor_theme_name;
   int cursor_theme_size;
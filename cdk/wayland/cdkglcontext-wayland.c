@@ -66,26 +66,7 @@ cdk_wayland_window_invalidate_for_new_frame (CdkWindow      *window,
 		       EGL_BUFFER_AGE_EXT, &buffer_age);
     }
 
-  invalidate_all = FALSE;
-  if (buffer_age == 0 || buffer_age >= 4)
-    invalidate_all = TRUE;
-  else
-    {
-      if (buffer_age >= 2)
-        {
-          if (window->old_updated_area[0])
-            cairo_region_union (update_area, window->old_updated_area[0]);
-          else
-            invalidate_all = TRUE;
-        }
-      if (buffer_age >= 3)
-        {
-          if (window->old_updated_area[1])
-            cairo_region_union (update_area, window->old_updated_area[1]);
-          else
-            invalidate_all = TRUE;
-        }
-    }
+  invalidate_all = !_cdk_window_add_buffer_age_damage (window, update_area, buffer_age);
 
   if (invalidate_all)
     {
@@ -59,6 +59,14 @@ static guint signals[LAST_SIGNAL];
 
 #define MAX_WL_BUFFER_SIZE (4083) /* 4096 minus header, string argument length and NUL byte */
 
+/* The oldest buffer whose contents we bring up to date from the damage
+ * of the frames committed since, rather than copying the whole window
+ */
+#define MAX_BUFFER_AGE 4
+
+/* How many buffers released by the compositor to keep for reuse */
+#define MAX_RELEASED_BUFFERS 2
+
 typedef struct _CdkWaylandWindow CdkWaylandWindow;
 typedef struct _CdkWaylandWindowClass CdkWaylandWindowClass;
 
@@ -147,6 +155,7 @@ struct _CdkWindowImplWayland
   unsigned int pending_buffer_attached : 1;
   unsigned int pending_commit : 1;
   unsigned int awaiting_frame : 1;
+  unsigned int pending_frame_has_feedback : 1;
   unsigned int using_csd : 1;
   CdkWindowTypeHint hint;
   CdkWindow *transient_for;
@@ -156,6 +165,7 @@ struct _CdkWindowImplWayland
   cairo_surface_t *staging_cairo_surface;
   cairo_surface_t *committed_cairo_surface;
   cairo_surface_t *backfill_cairo_surface;
+  GList *released_cairo_surfaces;
 
   int pending_buffer_offset_x;
   int pending_buffer_offset_y;
@@ -200,6 +210,12 @@ struct _CdkWindowImplWayland
 
   cairo_region_t *staged_updates_region;
 
+  /* Number of buffers committed so far, and the damage of the most
+   * recent ones, newest first
+   */
+  guint buffer_serial;
+  cairo_region_t *damage_history[MAX_BUFFER_AGE - 1];
+
   int saved_width;
   int saved_height;
   gboolean saved_size_changed;
@@ -300,6 +316,18 @@ _cdk_wayland_screen_add_orphan_dialog (CdkWindow *window)
       g_list_prepend (display_wayland->orphan_dialogs, window);
 }
 
+static void
+reset_damage_history (CdkWindowImplWayland *impl)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (impl->damage_history); i++)
+    g_clear_pointer (&impl->damage_history[i], cairo_region_destroy);
+
+  /* Make all buffers handed out so far too old to be brought up to date */
+  impl->buffer_serial += MAX_BUFFER_AGE;
+}
+
 static void
 drop_cairo_surfaces (CdkWindow *window)
 {
@@ -307,11 +335,18 @@ drop_cairo_surfaces (CdkWindow *window)
 
   g_clear_pointer (&impl->staging_cairo_surface, cairo_surface_destroy);
   g_clear_pointer (&impl->backfill_cairo_surface, cairo_surface_destroy);
+  g_clear_pointer (&impl->staged_updates_region, cairo_region_destroy);
+
+  g_list_free_full (impl->released_cairo_surfaces,
+                    (GDestroyNotify) cairo_surface_destroy);
+  impl->released_cairo_surfaces = NULL;
 
   /* We nullify this so if a buffer release comes in later, we won't
    * try to reuse that buffer since it's no longer suitable
    */
   impl->committed_cairo_surface = NULL;
+
+  reset_damage_history (impl);
 }
 
 static int
@@ -529,6 +564,130 @@ fill_presentation_time_from_frame_time (CdkFrameTimings *timings,
     }
 }
 
+static const cairo_user_data_key_t cdk_wayland_window_serial_key;
+
+static guint
+get_buffer_serial (cairo_surface_t *cairo_surface)
+{
+  return GPOINTER_TO_UINT (cairo_surface_get_user_data (cairo_surface,
+                                                        &cdk_wayland_window_serial_key));
+}
+
+/* Returns how many frames old the contents of @cairo_surface are: 1 if
+ * it holds the last committed frame, 2 if the one before, and so on, or
+ * 0 if its contents are unknown.
+ */
+static guint
+get_buffer_age (CdkWindowImplWayland *impl,
+                cairo_surface_t      *cairo_surface)
+{
+  guint serial;
+
+  serial = get_buffer_serial (cairo_surface);
+
+  if (serial == 0 || impl->buffer_serial - serial >= MAX_BUFFER_AGE)
+    return 0;
+
+  return impl->buffer_serial - serial + 1;
+}
+
+/* Returns the part of @window that changed since the contents of
+ * @cairo_surface were committed.
+ */
+static cairo_region_t *
+get_buffer_damage (CdkWindow       *window,
+                   cairo_surface_t *cairo_surface)
+{
+  CdkWindowImplWayland *impl = CDK_WINDOW_IMPL_WAYLAND (window->impl);
+  cairo_region_t *damage;
+  guint age, i;
+
+  age = get_buffer_age (impl, cairo_surface);
+  if (age == 0)
+    return cairo_region_copy (window->clip_region);
+
+  damage = cairo_region_create ();
+  for (i = 0; i + 1 < age; i++)
+    {
+      if (impl->damage_history[i] == NULL)
+        {
+          cairo_region_destroy (damage);
+          return cairo_region_copy (window->clip_region);
+        }
+
+      cairo_region_union (damage, impl->damage_history[i]);
+    }
+
+  return damage;
+}
+
+/* Records the updates staged into the buffer that is about to be
+ * committed as the damage of a new frame.
+ */
+static void
+push_buffer_damage (CdkWindow *window)
+{
+  CdkWindowImplWayland *impl = CDK_WINDOW_IMPL_WAYLAND (window->impl);
+  guint i;
+
+  i = G_N_ELEMENTS (impl->damage_history) - 1;
+  g_clear_pointer (&impl->damage_history[i], cairo_region_destroy);
+  for (; i > 0; i--)
+    impl->damage_history[i] = impl->damage_history[i - 1];
+
+  impl->damage_history[0] = g_steal_pointer (&impl->staged_updates_region);
+  if (impl->damage_history[0] == NULL)
+    impl->damage_history[0] = cairo_region_create ();
+
+  impl->buffer_serial++;
+  cairo_surface_set_user_data (impl->staging_cairo_surface,
+                               &cdk_wayland_window_serial_key,
+                               GUINT_TO_POINTER (impl->buffer_serial),
+                               NULL);
+}
+
+/* Keeps a buffer the compositor is done with around for drawing the
+ * next frames into, if its contents are recent enough to be useful.
+ */
+static void
+recycle_cairo_surface (CdkWindowImplWayland *impl,
+                       cairo_surface_t      *cairo_surface)
+{
+  if (get_buffer_age (impl, cairo_surface) == 0 ||
+      g_list_length (impl->released_cairo_surfaces) >= MAX_RELEASED_BUFFERS)
+    {
+      cairo_surface_destroy (cairo_surface);
+      return;
+    }
+
+  impl->released_cairo_surfaces = g_list_prepend (impl->released_cairo_surfaces,
+                                                  cairo_surface);
+}
+
+static cairo_surface_t *
+steal_youngest_released_surface (CdkWindowImplWayland *impl)
+{
+  cairo_surface_t *cairo_surface;
+  GList *l, *youngest;
+
+  youngest = NULL;
+  for (l = impl->released_cairo_surfaces; l; l = l->next)
+    {
+      if (youngest == NULL ||
+          get_buffer_serial (l->data) > get_buffer_serial (youngest->data))
+        youngest = l;
+    }
+
+  if (youngest == NULL)
+    return NULL;
+
+  cairo_surface = youngest->data;
+  impl->released_cairo_surfaces = g_list_delete_link (impl->released_cairo_surfaces,
+                                                      youngest);
+
+  return cairo_surface;
+}
+
 static void
 read_back_cairo_surface (CdkWindow *window)
 {
@@ -539,8 +698,13 @@ read_back_cairo_surface (CdkWindow *window)
   if (!impl->backfill_cairo_surface)
     goto out;
 
-  paint_region = cairo_region_copy (window->clip_region);
-  cairo_region_subtract (paint_region, impl->staged_updates_region);
+  /* Only the parts that changed since the staging buffer was last
+   * committed need to be copied over from the last frame.
+   */
+  paint_region = get_buffer_damage (window, impl->staging_cairo_surface);
+  cairo_region_intersect (paint_region, window->clip_region);
+  if (impl->staged_updates_region)
+    cairo_region_subtract (paint_region, impl->staged_updates_region);
 
   if (cairo_region_is_empty (paint_region))
     goto out;
@@ -556,10 +720,147 @@ read_back_cairo_surface (CdkWindow *window)
 
 out:
   g_clear_pointer (&paint_region, cairo_region_destroy);
-  g_clear_pointer (&impl->staged_updates_region, cairo_region_destroy);
   g_clear_pointer (&impl->backfill_cairo_surface, cairo_surface_destroy);
 }
 
+static void
+complete_frame_timings (CdkFrameClock   *clock,
+                        CdkFrameTimings *timings)
+{
+  timings->complete = TRUE;
+
+#ifdef G_ENABLE_DEBUG
+  if ((_cdk_debug_flags & CDK_DEBUG_FRAMES) != 0)
+    _cdk_frame_clock_debug_print_timings (clock, timings);
+
+  if (cdk_profiler_is_running ())
+    _cdk_frame_clock_add_timings_to_profiler (clock, timings);
+#endif
+}
+
+typedef struct
+{
+  CdkWindow *window;
+  gint64 frame_counter;
+} PresentationFeedback;
+
+static CdkFrameTimings *
+presentation_feedback_get_timings (PresentationFeedback *feedback,
+                                   CdkFrameClock       **clock)
+{
+  if (CDK_WINDOW_DESTROYED (feedback->window))
+    return NULL;
+
+  *clock = cdk_window_get_frame_clock (feedback->window);
+  if (*clock == NULL)
+    return NULL;
+
+  return cdk_frame_clock_get_timings (*clock, feedback->frame_counter);
+}
+
+static void
+presentation_feedback_free (PresentationFeedback            *feedback,
+                            struct wp_presentation_feedback *wp_feedback)
+{
+  wp_presentation_feedback_destroy (wp_feedback);
+  g_object_unref (feedback->window);
+  g_free (feedback);
+}
+
+static void
+presentation_feedback_sync_output (void                            *data,
+                                   struct wp_presentation_feedback *wp_feedback,
+                                   struct wl_output                *output)
+{
+}
+
+static void
+presentation_feedback_presented (void                            *data,
+                                 struct wp_presentation_feedback *wp_feedback,
+                                 uint32_t                         tv_sec_hi,
+                                 uint32_t                         tv_sec_lo,
+                                 uint32_t                         tv_nsec,
+                                 uint32_t                         refresh,
+                                 uint32_t                         seq_hi,
+                                 uint32_t                         seq_lo,
+                                 uint32_t                         flags)
+{
+  PresentationFeedback *feedback = data;
+  CdkFrameClock *clock;
+  CdkFrameTimings *timings;
+
+  timings = presentation_feedback_get_timings (feedback, &clock);
+  if (timings != NULL && !timings->complete)
+    {
+      timings->presentation_time =
+        ((((gint64) tv_sec_hi << 32) | tv_sec_lo) * G_USEC_PER_SEC) + tv_nsec / 1000;
+      if (refresh != 0)
+        timings->refresh_interval = refresh / 1000;
+
+      complete_frame_timings (clock, timings);
+    }
+
+  presentation_feedback_free (feedback, wp_feedback);
+}
+
+static void
+presentation_feedback_discarded (void                            *data,
+                                 struct wp_presentation_feedback *wp_feedback)
+{
+  PresentationFeedback *feedback = data;
+  CdkFrameClock *clock;
+  CdkFrameTimings *timings;
+
+  /* The frame never made it to the screen, so there is no
+   * presentation time to report
+   */
+  timings = presentation_feedback_get_timings (feedback, &clock);
+  if (timings != NULL && !timings->complete)
+    {
+      timings->presentation_time = 0;
+      complete_frame_timings (clock, timings);
+    }
+
+  presentation_feedback_free (feedback, wp_feedback);
+}
+
+static const struct wp_presentation_feedback_listener presentation_feedback_listener = {
+  presentation_feedback_sync_output,
+  presentation_feedback_presented,
+  presentation_feedback_discarded
+};
+
+/* Asks the compositor when the content of the next commit actually hits
+ * the screen, which is more precise than guessing from the frame
+ * callback. Returns whether feedback was requested.
+ */
+static gboolean
+request_presentation_feedback (CdkWindow *window,
+                               gint64     frame_counter)
+{
+  CdkWindowImplWayland *impl = CDK_WINDOW_IMPL_WAYLAND (window->impl);
+  CdkWaylandDisplay *display_wayland =
+    CDK_WAYLAND_DISPLAY (cdk_window_get_display (window));
+  struct wp_presentation_feedback *wp_feedback;
+  PresentationFeedback *feedback;
+
+  if (display_wayland->presentation == NULL ||
+      !display_wayland->presentation_clock_is_monotonic)
+    return FALSE;
+
+  feedback = g_new (PresentationFeedback, 1);
+  feedback->window = g_object_ref (window);
+  feedback->frame_counter = frame_counter;
+
+  wp_feedback = wp_presentation_feedback (display_wayland->presentation,
+                                          impl->display_server.wl_surface);
+  wp_presentation_feedback_add_listener (wp_feedback,
+                                         &presentation_feedback_listener,
+                                         feedback);
+
+  return TRUE;
+}
+
 static void
 frame_callback (void               *data,
                 struct wl_callback *callback,
@@ -589,10 +890,11 @@ frame_callback (void               *data,
   timings = cdk_frame_clock_get_timings (clock, impl->pending_frame_counter);
   impl->pending_frame_counter = 0;
 
-  if (timings == NULL)
+  /* Presentation feedback may have arrived first */
+  if (timings == NULL || timings->complete)
     return;
 
-  timings->refresh_interval = 16667; /* default to 1/60th of a second */
+  timings->refresh_interval = _cdk_frame_clock_get_refresh_interval (clock);
   if (impl->display_server.outputs)
     {
       /* We pick a random output out of the outputs that the window touches
@@ -606,15 +908,11 @@ frame_callback (void               *data,
 
   fill_presentation_time_from_frame_time (timings, time);
 
-  timings->complete = TRUE;
-
-#ifdef G_ENABLE_DEBUG
-  if ((_cdk_debug_flags & CDK_DEBUG_FRAMES) != 0)
-    _cdk_frame_clock_debug_print_timings (clock, timings);
-
-  if (cdk_profiler_is_running ())
-    _cdk_frame_clock_add_timings_to_profiler (clock, timings);
-#endif
+  /* Otherwise, the presentation feedback completes the timings with
+   * the real presentation time once the frame is on screen.
+   */
+  if (!impl->pending_frame_has_feedback)
+    complete_frame_timings (clock, timings);
 }
 
 static const struct wl_callback_listener frame_listener = {
@@ -685,10 +983,16 @@ on_frame_clock_after_paint (CdkFrameClock *clock,
    * before we need to stage any changes, then we can take it back and
    * use it again.
    */
+  impl->pending_frame_has_feedback =
+    request_presentation_feedback (window, cdk_frame_clock_get_frame_counter (clock));
+
   wl_surface_commit (impl->display_server.wl_surface);
 
-  if (impl->pending_buffer_attached)
-    impl->committed_cairo_surface = g_steal_pointer (&impl->staging_cairo_surface);
+  if (impl->pending_buffer_attached && impl->staging_cairo_surface)
+    {
+      push_buffer_damage (window);
+      impl->committed_cairo_surface = g_steal_pointer (&impl->staging_cairo_surface);
+    }
 
   impl->pending_buffer_attached = FALSE;
   impl->pending_commit = FALSE;
@@ -861,7 +1165,7 @@ buffer_release_callback (void             *_data,
        */
       g_warn_if_fail (impl->staging_cairo_surface != cairo_surface);
 
-      cairo_surface_destroy (cairo_surface);
+      recycle_cairo_surface (impl, cairo_surface);
       return;
     }
 
@@ -873,26 +1177,30 @@ buffer_release_callback (void             *_data,
       g_warn_if_fail (impl->staging_cairo_surface != NULL);
 
       /* If we've staged updates into a new buffer before the release for this
-       * buffer came in, then we can't reuse this buffer, so unref it. It may still
-       * be alive as a readback buffer though (via impl->backfill_cairo_surface).
+       * buffer came in, then we can't reuse this buffer right now. Keep it for
+       * one of the next frames instead; it may also still be alive as a
+       * readback buffer (via impl->backfill_cairo_surface).
        *
        * It's possible a staging surface was allocated but no updates were staged.
-       * If that happened, clean up that staging surface now, since the old commit
+       * If that happened, put that staging surface back now, since the old commit
        * buffer is available again, and reusing the old commit buffer for future
        * updates will save having to do a read back later.
        */
       if (!cairo_region_is_empty (impl->staged_updates_region))
         {
-          g_clear_pointer (&impl->committed_cairo_surface, cairo_surface_destroy);
+          recycle_cairo_surface (impl, g_steal_pointer (&impl->committed_cairo_surface));
           return;
         }
       else
         {
           g_clear_pointer (&impl->staged_updates_region, cairo_region_destroy);
-          g_clear_pointer (&impl->staging_cairo_surface, cairo_surface_destroy);
+          g_clear_pointer (&impl->backfill_cairo_surface, cairo_surface_destroy);
         }
     }
 
+  if (impl->staging_cairo_surface)
+    recycle_cairo_surface (impl, g_steal_pointer (&impl->staging_cairo_surface));
+
   /* Release came in, we haven't done any interim updates, so we can just use
    * the old committed buffer again.
    */
@@ -929,6 +1237,13 @@ cdk_wayland_window_ensure_cairo_surface (CdkWindow *window)
       CdkWaylandDisplay *display_wayland = CDK_WAYLAND_DISPLAY (cdk_window_get_display (impl->wrapper));
       struct wl_buffer *buffer;
 
+      /* Prefer a buffer the compositor gave back, so that only the damage
+       * of the frames since it was committed has to be copied into it.
+       */
+      impl->staging_cairo_surface = steal_youngest_released_surface (impl);
+      if (impl->staging_cairo_surface)
+        return;
+
       impl->staging_cairo_surface = _cdk_wayland_display_create_shm_surface (display_wayland,
                                                                              impl->wrapper->width,
                                                                              impl->wrapper->height,
@@ -1000,22 +1315,20 @@ cdk_window_impl_wayland_end_paint (CdkWindow *window)
 
       cdk_wayland_window_attach_image (window);
 
-      /* If there's a committed buffer pending, then track which
-       * updates are staged until the next frame, so we can back
-       * fill the unstaged parts of the staging buffer with the
-       * last frame.
+      /* Track which updates are staged until the next frame. They
+       * are the damage of that frame, and if there's a committed
+       * buffer pending, we back fill the parts of the staging buffer
+       * that are older than the last frame from it.
        */
-      if (impl->committed_cairo_surface != NULL)
+      if (impl->staged_updates_region == NULL)
         {
-          if (impl->staged_updates_region == NULL)
-            {
-              impl->staged_updates_region = cairo_region_copy (window->current_paint.region);
-              impl->backfill_cairo_surface = cairo_surface_reference (impl->committed_cairo_surface);
-            }
-          else
-            {
-              cairo_region_union (impl->staged_updates_region, window->current_paint.region);
-            }
+          impl->staged_updates_region = cairo_region_copy (window->current_paint.region);
+          if (impl->committed_cairo_surface != NULL)
+            impl->backfill_cairo_surface = cairo_surface_reference (impl->committed_cairo_surface);
+        }
+      else
+        {
+          cairo_region_union (impl->staged_updates_region, window->current_paint.region);
         }
 
       n = cairo_region_num_rectangles (window->current_paint.region);
@@ -1066,6 +1379,7 @@ cdk_window_impl_wayland_finalize (GObject *object)
   g_clear_pointer (&impl->opaque_region, cairo_region_destroy);
   g_clear_pointer (&impl->input_region, cairo_region_destroy);
   g_clear_pointer (&impl->staged_updates_region, cairo_region_destroy);
+  reset_damage_history (impl);
 
   g_clear_pointer (&impl->shortcuts_inhibitors, g_hash_table_unref);
 
@@ -1485,6 +1799,7 @@ surface_enter (void              *data,
   impl->display_server.outputs = g_slist_prepend (impl->display_server.outputs, output);
 
   window_update_scale (window);
+  _cdk_window_update_frame_clock_monitor (window);
 }
 
 static void
@@ -1501,7 +1816,10 @@ surface_leave (void              *data,
   impl->display_server.outputs = g_slist_remove (impl->display_server.outputs, output);
 
   if (impl->display_server.outputs)
-    window_update_scale (window);
+    {
+      window_update_scale (window);
+      _cdk_window_update_frame_clock_monitor (window);
+    }
 }
 
 static const struct wl_surface_listener surface_listener = {
@@ -268,6 +268,8 @@ cdk_x11_device_core_query_state (CdkDevice        *device,
   display = cdk_window_get_display (window);
   default_screen = cdk_display_get_default_screen (display);
 
+  _cdk_x11_display_count_round_trip (display);
+
   if (!CDK_X11_DISPLAY (display)->trusted_client ||
       !XQueryPointer (CDK_WINDOW_XDISPLAY (window),
                       CDK_WINDOW_XID (window),
@@ -351,6 +351,8 @@ cdk_x11_device_xi2_query_state (CdkDevice        *device,
       return;
     }
 
+  _cdk_x11_display_count_round_trip (display);
+
   if (!CDK_X11_DISPLAY (display)->trusted_client ||
       !XIQueryPointer (CDK_WINDOW_XDISPLAY (window),
                        device_xi2->device_id,
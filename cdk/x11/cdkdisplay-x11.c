@@ -930,7 +930,15 @@ cdk_x11_display_translate_event (CdkEventTranslator *translator,
 			   xevent->xreparent.parent,
 			   xevent->xreparent.override_redirect));
 
-      /* Not currently handled */
+      /* The window manager framed or unframed the window, our
+       * idea of where it is can no longer be trusted.
+       */
+      if (window_impl && !is_substructure)
+        {
+          window_impl->root_origin_valid = FALSE;
+          window_impl->frame_extents_valid = FALSE;
+        }
+
       return_val = FALSE;
       break;
 
@@ -994,6 +1002,7 @@ cdk_x11_display_translate_event (CdkEventTranslator *translator,
 	      Window child_window = 0;
 
 	      cdk_x11_display_error_trap_push (display);
+	      _cdk_x11_display_count_round_trip (display);
 	      if (XTranslateCoordinates (CDK_WINDOW_XDISPLAY (window),
 					 CDK_WINDOW_XID (window),
 					 x11_screen->xroot_window,
@@ -1003,6 +1012,13 @@ cdk_x11_display_translate_event (CdkEventTranslator *translator,
 		{
 		  event->configure.x = tx / window_impl->window_scale;
 		  event->configure.y = ty / window_impl->window_scale;
+
+		  if (!is_substructure)
+		    {
+		      window_impl->root_x = tx;
+		      window_impl->root_y = ty;
+		      window_impl->root_origin_valid = TRUE;
+		    }
 		}
 	      cdk_x11_display_error_trap_pop_ignored (display);
 	    }
@@ -1010,6 +1026,16 @@ cdk_x11_display_translate_event (CdkEventTranslator *translator,
 	    {
 	      event->configure.x = xevent->xconfigure.x / window_impl->window_scale;
 	      event->configure.y = xevent->xconfigure.y / window_impl->window_scale;
+
+	      /* Synthetic events from the window manager and events for
+	       * override-redirect windows are relative to the root window
+	       */
+	      if (!is_substructure)
+		{
+		  window_impl->root_x = xevent->xconfigure.x;
+		  window_impl->root_y = xevent->xconfigure.y;
+		  window_impl->root_origin_valid = TRUE;
+		}
 	    }
 	  if (!is_substructure)
 	    {
@@ -1054,6 +1080,9 @@ cdk_x11_display_translate_event (CdkEventTranslator *translator,
           break;
         }
 
+      if (xevent->xproperty.atom == cdk_x11_get_xatom_by_name_for_display (display, "_NET_FRAME_EXTENTS"))
+        window_impl->frame_extents_valid = FALSE;
+
       /* We compare with the serial of the last time we mapped the
        * window to avoid refetching properties that we set ourselves
        */
@@ -2068,6 +2097,12 @@ cdk_x11_display_dispose (GObject *object)
       display_x11->event_source = NULL;
     }
 
+  if (display_x11->report_round_trips_id)
+    {
+      g_source_remove (display_x11->report_round_trips_id);
+      display_x11->report_round_trips_id = 0;
+    }
+
   G_OBJECT_CLASS (cdk_x11_display_parent_class)->dispose (object);
 }
 
@@ -2777,6 +2812,61 @@ _cdk_x11_display_error_event (CdkDisplay  *display,
     }
 }
 
+/* Notes that a request that blocks on a reply from the server is
+ * about to be made. These are what makes a client slow over a high
+ * latency connection, so they are counted per frame.
+ */
+void
+_cdk_x11_display_count_round_trip (CdkDisplay *display)
+{
+  CDK_X11_DISPLAY (display)->round_trips++;
+}
+
+static gboolean
+report_round_trips (gpointer data)
+{
+  CdkX11Display *display_x11 = data;
+  static guint round_trips_counter = 0;
+
+  display_x11->report_round_trips_id = 0;
+
+  CDK_NOTE (FRAMES,
+            if (display_x11->round_trips > 0)
+              g_message ("%u round trips since the last frame", display_x11->round_trips));
+
+  if (cdk_profiler_is_running ())
+    {
+      if (round_trips_counter == 0)
+        round_trips_counter = cdk_profiler_define_int_counter ("x11-round-trips",
+                                                               "X server round trips per frame");
+
+      cdk_profiler_set_int_counter (round_trips_counter,
+                                    g_get_monotonic_time () * 1000,
+                                    display_x11->round_trips);
+    }
+
+  display_x11->round_trips = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Called after each window paints. The round trips are counted for the
+ * whole display, so they are reported once all windows painting in this
+ * main loop iteration are done.
+ */
+void
+_cdk_x11_display_report_round_trips (CdkDisplay *display)
+{
+  CdkX11Display *display_x11 = CDK_X11_DISPLAY (display);
+
+  if (display_x11->report_round_trips_id != 0)
+    return;
+
+  display_x11->report_round_trips_id =
+    cdk_threads_add_idle_full (CDK_PRIORITY_REDRAW + 1, report_round_trips, display_x11, NULL);
+  g_source_set_name_by_id (display_x11->report_round_trips_id, "[ctk+] report_round_trips");
+}
+
 static void
 delete_outdated_error_traps (CdkX11Display *display_x11)
 {
@@ -2888,6 +2978,7 @@ cdk_x11_display_error_trap_pop_internal (CdkDisplay *display,
        */
       if ((next_sequence - 1) != processed_sequence)
         {
+          _cdk_x11_display_count_round_trip (display);
           XSync (display_x11->xdisplay, False);
         }
 
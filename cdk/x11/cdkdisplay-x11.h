@@ -137,6 +137,10 @@ struct _CdkX11Display
 
   guint server_time_is_monotonic_time : 1;
 
+  /* Requests that waited for a reply since the last frame */
+  guint round_trips;
+  guint report_round_trips_id;
+
   guint have_glx : 1;
 
   /* GLX extensions we check */
@@ -149,7 +149,7 @@ cdk_x11_window_invalidate_for_new_frame (CdkWindow      *window,
 
 
   invalidate_all = FALSE;
-  if (buffer_age >= 4)
+  if (buffer_age > CDK_WINDOW_MAX_BUFFER_AGE)
     {
       cairo_rectangle_int_t whole_window = { 0, 0, cdk_window_get_width (window), cdk_window_get_height (window) };
 
@@ -161,26 +161,9 @@ cdk_x11_window_invalidate_for_new_frame (CdkWindow      *window,
       else
         invalidate_all = TRUE;
     }
-  else
+  else if (!_cdk_window_add_buffer_age_damage (window, update_area, buffer_age))
     {
-      if (buffer_age == 0)
-        {
-          invalidate_all = TRUE;
-        }
-      if (buffer_age >= 2)
-        {
-          if (window->old_updated_area[0])
-            cairo_region_union (update_area, window->old_updated_area[0]);
-          else
-            invalidate_all = TRUE;
-        }
-      if (buffer_age >= 3)
-        {
-          if (window->old_updated_area[1])
-            cairo_region_union (update_area, window->old_updated_area[1]);
-          else
-            invalidate_all = TRUE;
-        }
+      invalidate_all = TRUE;
     }
 
   if (invalidate_all)
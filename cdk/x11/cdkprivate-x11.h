@@ -281,6 +281,8 @@ void       _cdk_x11_display_get_maximal_cursor_size (CdkDisplay *display,
                                                      guint      *height);
 void       _cdk_x11_display_before_process_all_updates (CdkDisplay *display);
 void       _cdk_x11_display_after_process_all_updates  (CdkDisplay *display);
+void       _cdk_x11_display_count_round_trip           (CdkDisplay *display);
+void       _cdk_x11_display_report_round_trips         (CdkDisplay *display);
 void       _cdk_x11_display_create_window_impl     (CdkDisplay    *display,
                                                     CdkWindow     *window,
                                                     CdkWindow     *real_parent,
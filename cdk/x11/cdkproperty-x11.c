@@ -416,6 +416,7 @@ _cdk_x11_window_get_property (CdkWindow   *window,
       return FALSE;
     }
 
+  _cdk_x11_display_count_round_trip (display);
   res = XGetWindowProperty (CDK_DISPLAY_XDISPLAY (display),
 			    CDK_WINDOW_XID (window), xproperty,
 			    offset, get_length, pdelete,
@@ -994,6 +994,7 @@ on_frame_clock_after_paint (CdkFrameClock *clock,
 {
   cdk_x11_window_end_frame (window);
 
+  _cdk_x11_display_report_round_trips (cdk_window_get_display (window));
 }
 
 static void
@@ -1825,7 +1826,13 @@ window_x11_move (CdkWindow *window,
         {
           window->x = x;
           window->y = y;
+
+          impl->root_x = x * impl->window_scale;
+          impl->root_y = y * impl->window_scale;
+          impl->root_origin_valid = TRUE;
         }
+      else
+        impl->root_origin_valid = FALSE;
     }
 }
 
@@ -1868,6 +1875,10 @@ window_x11_resize (CdkWindow *window,
         {
           if (width * impl->window_scale != impl->unscaled_width || height * impl->window_scale != impl->unscaled_height)
             window->resize_count += 1;
+
+          /* The window manager may move the window to satisfy the
+           * new size */
+          impl->root_origin_valid = FALSE;
         }
     }
 }
@@ -1906,6 +1917,10 @@ window_x11_move_resize (CdkWindow *window,
           window->x = x;
           window->y = y;
 
+          impl->root_x = x * impl->window_scale;
+          impl->root_y = y * impl->window_scale;
+          impl->root_origin_valid = TRUE;
+
           impl->unscaled_width = width * impl->window_scale;
           impl->unscaled_height = height * impl->window_scale;
           window->width = width;
@@ -1917,6 +1932,8 @@ window_x11_move_resize (CdkWindow *window,
         {
           if (width * impl->window_scale != impl->unscaled_width || height * impl->window_scale != impl->unscaled_height)
             window->resize_count += 1;
+
+          impl->root_origin_valid = FALSE;
         }
     }
 }
@@ -3170,6 +3187,7 @@ cdk_window_x11_get_geometry (CdkWindow *window,
 
       impl = CDK_WINDOW_IMPL_X11 (window->impl);
 
+      _cdk_x11_display_count_round_trip (CDK_WINDOW_DISPLAY (window));
       XGetGeometry (CDK_WINDOW_XDISPLAY (window),
 		    CDK_WINDOW_XID (window),
 		    &root, &tx, &ty, &twidth, &theight, &tborder_width, &tdepth);
@@ -3196,12 +3214,21 @@ cdk_window_x11_get_root_coords (CdkWindow *window,
   Window child;
   gint tx;
   gint ty;
-  
-  XTranslateCoordinates (CDK_WINDOW_XDISPLAY (window),
-                         CDK_WINDOW_XID (window),
-                         CDK_WINDOW_XROOTWIN (window),
-                         x * impl->window_scale, y * impl->window_scale, &tx, &ty,
-                         &child);
+
+  if (impl->root_origin_valid)
+    {
+      tx = impl->root_x + x * impl->window_scale;
+      ty = impl->root_y + y * impl->window_scale;
+    }
+  else
+    {
+      _cdk_x11_display_count_round_trip (CDK_WINDOW_DISPLAY (window));
+      XTranslateCoordinates (CDK_WINDOW_XDISPLAY (window),
+                             CDK_WINDOW_XID (window),
+                             CDK_WINDOW_XROOTWIN (window),
+                             x * impl->window_scale, y * impl->window_scale, &tx, &ty,
+                             &child);
+    }
 
   if (root_x)
     *root_x = tx / impl->window_scale;
@@ -3259,10 +3286,24 @@ cdk_x11_window_get_frame_extents (CdkWindow    *window,
 
   display = cdk_window_get_display (window);
 
+  /* Answer from what we know from events if we can */
+  if (impl->frame_extents_valid && impl->root_origin_valid)
+    {
+      rect->x = impl->root_x - impl->frame_extents[0];
+      rect->y = impl->root_y - impl->frame_extents[2];
+      rect->width = impl->unscaled_width + impl->frame_extents[0] + impl->frame_extents[1];
+      rect->height = impl->unscaled_height + impl->frame_extents[2] + impl->frame_extents[3];
+
+      cdk_x11_display_error_trap_push (display);
+      goto out;
+    }
+
   cdk_x11_display_error_trap_push (display);
 
   xwindow = CDK_WINDOW_XID (window);
 
+  _cdk_x11_display_count_round_trip (display);
+
   /* first try: use _NET_FRAME_EXTENTS */
   if (cdk_x11_screen_supports_net_wm_hint (CDK_WINDOW_SCREEN (window),
                                            cdk_atom_intern_static_string ("_NET_FRAME_EXTENTS")) &&
@@ -3280,16 +3321,33 @@ cdk_x11_window_get_frame_extents (CdkWindow    *window,
 	  gulong *ldata = (gulong *) data;
 	  got_frame_extents = TRUE;
 
+	  for (i = 0; i < 4; i++)
+	    impl->frame_extents[i] = ldata[i];
+	  impl->frame_extents_valid = TRUE;
+
 	  /* try to get the real client window geometry */
-	  if (XGetGeometry (CDK_DISPLAY_XDISPLAY (display), xwindow,
-			    &root, &wx, &wy, &ww, &wh, &wb, &wd) &&
-              XTranslateCoordinates (CDK_DISPLAY_XDISPLAY (display),
-	  			     xwindow, root, 0, 0, &wx, &wy, &child))
-            {
-	      rect->x = wx;
-	      rect->y = wy;
-	      rect->width = ww;
-	      rect->height = wh;
+	  if (impl->root_origin_valid)
+	    {
+	      rect->x = impl->root_x;
+	      rect->y = impl->root_y;
+	      rect->width = impl->unscaled_width;
+	      rect->height = impl->unscaled_height;
+	    }
+	  else
+	    {
+	      _cdk_x11_display_count_round_trip (display);
+	      _cdk_x11_display_count_round_trip (display);
+
+	      if (XGetGeometry (CDK_DISPLAY_XDISPLAY (display), xwindow,
+				&root, &wx, &wy, &ww, &wh, &wb, &wd) &&
+		  XTranslateCoordinates (CDK_DISPLAY_XDISPLAY (display),
+					 xwindow, root, 0, 0, &wx, &wy, &child))
+		{
+		  rect->x = wx;
+		  rect->y = wy;
+		  rect->width = ww;
+		  rect->height = wh;
+		}
 	    }
 
 	  /* _NET_FRAME_EXTENTS format is left, right, top, bottom */
@@ -3336,6 +3394,7 @@ cdk_x11_window_get_frame_extents (CdkWindow    *window,
     {
       xwindow = xparent;
 
+      _cdk_x11_display_count_round_trip (display);
       if (!XQueryTree (CDK_DISPLAY_XDISPLAY (display), xwindow,
 		       &root, &xparent,
 		       &children, &nchildren))
@@ -3356,6 +3415,7 @@ cdk_x11_window_get_frame_extents (CdkWindow    *window,
     }
   while (xparent != root);
 
+  _cdk_x11_display_count_round_trip (display);
   if (XGetGeometry (CDK_DISPLAY_XDISPLAY (display), xwindow,
 		    &root, &wx, &wy, &ww, &wh, &wb, &wd))
     {
@@ -3411,6 +3471,7 @@ cdk_window_x11_get_events (CdkWindow *window)
     return 0;
   else
     {
+      _cdk_x11_display_count_round_trip (CDK_WINDOW_DISPLAY (window));
       XGetWindowAttributes (CDK_WINDOW_XDISPLAY (window),
 			    CDK_WINDOW_XID (window),
 			    &attrs);
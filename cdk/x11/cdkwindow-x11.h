@@ -85,6 +85,16 @@ struct _CdkWindowImplX11
   gint unscaled_width;
   gint unscaled_height;
 
+  /* Unscaled position of a toplevel relative to the root window and
+   * its _NET_FRAME_EXTENTS, tracked from ConfigureNotify and
+   * PropertyNotify events so they need not be queried from the server.
+   */
+  gint root_x;
+  gint root_y;
+  gint frame_extents[4];
+  guint root_origin_valid : 1;
+  guint frame_extents_valid : 1;
+
   cairo_surface_t *cairo_surface;
 
 #if defined (HAVE_XCOMPOSITE) && defined(HAVE_XDAMAGE) && defined (HAVE_XFIXES)
@@ -29,6 +29,7 @@
 #include "ctkversion.h"
 #include "ctktypebuiltins.h"
 #include "ctkintl.h"
+#include "ctkprofilerprivate.h"
 #include "fallback-memdup.h"
 
 
@@ -1221,6 +1222,9 @@ _ctk_builder_parser_parse_buffer (CtkBuilder   *builder,
   const gchar* domain;
   ParserData *data;
   GSList *l;
+  gint64 before;
+
+  before = CTK_PROFILER_CURRENT_TIME;
 
   /* Store the original domain so that interface domain attribute can be
    * applied for the builder and the original domain can be restored after
@@ -1304,4 +1308,6 @@ _ctk_builder_parser_parse_buffer (CtkBuilder   *builder,
 
   /* restore the original domain */
   ctk_builder_set_translation_domain (builder, domain);
+
+  ctk_profiler_end_mark (before, "builder parse", filename ? filename : "");
 }
@@ -410,6 +410,25 @@ _ctk_css_image_get_surface (CtkCssImage     *image,
   return result;
 }
 
+/* Whether drawing on @cr produces vector output, such as when printing.
+ * Images should not substitute cached pixels for real drawing there.
+ */
+gboolean
+_ctk_css_image_target_is_vector (cairo_t *cr)
+{
+  switch ((int) cairo_surface_get_type (cairo_get_target (cr)))
+    {
+    case CAIRO_SURFACE_TYPE_PDF:
+    case CAIRO_SURFACE_TYPE_PS:
+    case CAIRO_SURFACE_TYPE_SVG:
+    case CAIRO_SURFACE_TYPE_RECORDING:
+    case CAIRO_SURFACE_TYPE_SCRIPT:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
 static GType
 ctk_css_image_get_parser_type (CtkCssParser *parser)
 {
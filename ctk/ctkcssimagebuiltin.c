@@ -822,19 +822,13 @@ ctk_css_image_builtin_new (void)
   return the_one_true_image;
 }
 
-void
-ctk_css_image_builtin_draw (CtkCssImage            *image,
-                            cairo_t                *cr,
-                            double                  width,
-                            double                  height,
-                            CtkCssImageBuiltinType  image_type)
+static void
+ctk_css_image_builtin_draw_uncached (CtkCssImage            *image,
+                                     cairo_t                *cr,
+                                     double                  width,
+                                     double                  height,
+                                     CtkCssImageBuiltinType  image_type)
 {
-  if (!CTK_IS_CSS_IMAGE_BUILTIN (image))
-    {
-      _ctk_css_image_draw (image, cr, width, height);
-      return;
-    }
-
   switch (image_type)
   {
   default:
@@ -931,3 +925,257 @@ ctk_css_image_builtin_draw (CtkCssImage            *image,
   }
 }
 
+/* The atlas: builtin images are small, drawn in large numbers (think
+ * of the expanders and checkboxes of a tree view) and only depend on
+ * their type, size and colors. When enabled, they are rendered once
+ * into a shared surface per scale factor and copied from there.
+ *
+ * Slots are allocated in rows ("shelves") of similar height. When the
+ * atlas is full, it is cleared and filled again from scratch.
+ */
+#define ATLAS_SIZE 256
+#define ATLAS_MAX_IMAGE_SIZE 64
+#define ATLAS_MAX_SCALE 4
+
+typedef struct
+{
+  CtkCssImageBuiltinType type;
+  gint                   width;
+  gint                   height;
+  CdkRGBA                fg_color;
+  CdkRGBA                bg_color;
+} AtlasKey;
+
+typedef struct
+{
+  AtlasKey key;
+  gint     x;
+  gint     y;
+} AtlasEntry;
+
+typedef struct
+{
+  cairo_surface_t *surface;
+  gint             scale;
+  GHashTable      *entries;
+  gint             shelf_x;
+  gint             shelf_y;
+  gint             shelf_height;
+} Atlas;
+
+static Atlas *atlases[ATLAS_MAX_SCALE];
+
+static gboolean
+atlas_enabled (void)
+{
+  static gint enabled = -1;
+
+  if (enabled == -1)
+    enabled = g_strcmp0 (g_getenv ("CTK_BUILTIN_IMAGE_ATLAS"), "1") == 0;
+
+  return enabled;
+}
+
+static guint
+atlas_key_hash (gconstpointer data)
+{
+  const AtlasKey *key = data;
+
+  return key->type ^ (key->width << 8) ^ (key->height << 16) ^
+         cdk_rgba_hash (&key->fg_color) ^ (cdk_rgba_hash (&key->bg_color) << 1);
+}
+
+static gboolean
+atlas_key_equal (gconstpointer a,
+                 gconstpointer b)
+{
+  const AtlasKey *key_a = a;
+  const AtlasKey *key_b = b;
+
+  return key_a->type == key_b->type &&
+         key_a->width == key_b->width &&
+         key_a->height == key_b->height &&
+         cdk_rgba_equal (&key_a->fg_color, &key_b->fg_color) &&
+         cdk_rgba_equal (&key_a->bg_color, &key_b->bg_color);
+}
+
+static Atlas *
+atlas_get (gint scale)
+{
+  Atlas *atlas = atlases[scale - 1];
+
+  if (atlas == NULL)
+    {
+      atlas = g_new0 (Atlas, 1);
+      atlas->scale = scale;
+      atlas->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, ATLAS_SIZE, ATLAS_SIZE);
+      cairo_surface_set_device_scale (atlas->surface, scale, scale);
+      atlas->entries = g_hash_table_new_full (atlas_key_hash, atlas_key_equal, NULL, g_free);
+      atlases[scale - 1] = atlas;
+    }
+
+  return atlas;
+}
+
+static void
+atlas_clear (Atlas *atlas)
+{
+  cairo_t *cr;
+
+  cr = cairo_create (atlas->surface);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+
+  g_hash_table_remove_all (atlas->entries);
+  atlas->shelf_x = 0;
+  atlas->shelf_y = 0;
+  atlas->shelf_height = 0;
+}
+
+/* Finds room for a width x height pixel slot, in device pixels */
+static gboolean
+atlas_allocate (Atlas *atlas,
+                gint   width,
+                gint   height,
+                gint  *x,
+                gint  *y)
+{
+  if (atlas->shelf_x + width > ATLAS_SIZE)
+    {
+      atlas->shelf_x = 0;
+      atlas->shelf_y += atlas->shelf_height;
+      atlas->shelf_height = 0;
+    }
+
+  if (atlas->shelf_y + height > ATLAS_SIZE)
+    return FALSE;
+
+  *x = atlas->shelf_x;
+  *y = atlas->shelf_y;
+  atlas->shelf_x += width;
+  atlas->shelf_height = MAX (atlas->shelf_height, height);
+
+  return TRUE;
+}
+
+static AtlasEntry *
+atlas_lookup (Atlas          *atlas,
+              CtkCssImage    *image,
+              const AtlasKey *key)
+{
+  AtlasEntry *entry;
+  cairo_t *cr;
+  gint x, y;
+
+  entry = g_hash_table_lookup (atlas->entries, key);
+  if (entry)
+    return entry;
+
+  if (!atlas_allocate (atlas, key->width * atlas->scale, key->height * atlas->scale, &x, &y))
+    {
+      atlas_clear (atlas);
+      if (!atlas_allocate (atlas, key->width * atlas->scale, key->height * atlas->scale, &x, &y))
+        return NULL;
+    }
+
+  entry = g_new (AtlasEntry, 1);
+  entry->key = *key;
+  entry->x = x;
+  entry->y = y;
+  g_hash_table_insert (atlas->entries, &entry->key, entry);
+
+  cr = cairo_create (atlas->surface);
+  cairo_translate (cr, (double) x / atlas->scale, (double) y / atlas->scale);
+  cairo_rectangle (cr, 0, 0, key->width, key->height);
+  cairo_clip (cr);
+  ctk_css_image_builtin_draw_uncached (image, cr, key->width, key->height, key->type);
+  cairo_destroy (cr);
+
+  return entry;
+}
+
+/* Draws the image from the atlas if @cr maps it to whole device pixels,
+ * where copying the cached pixels gives the same result as drawing.
+ */
+static gboolean
+ctk_css_image_builtin_draw_from_atlas (CtkCssImage            *image,
+                                       cairo_t                *cr,
+                                       double                  width,
+                                       double                  height,
+                                       CtkCssImageBuiltinType  image_type)
+{
+  CtkCssImageBuiltin *builtin = CTK_CSS_IMAGE_BUILTIN (image);
+  cairo_matrix_t matrix;
+  double xscale, yscale;
+  double x, y;
+  AtlasEntry *entry;
+  AtlasKey key;
+  Atlas *atlas;
+
+  if (_ctk_css_image_target_is_vector (cr))
+    return FALSE;
+
+  if (width != (gint) width || height != (gint) height ||
+      width <= 0 || height <= 0 ||
+      width > ATLAS_MAX_IMAGE_SIZE || height > ATLAS_MAX_IMAGE_SIZE)
+    return FALSE;
+
+  cairo_get_matrix (cr, &matrix);
+  if (matrix.xx != 1.0 || matrix.yy != 1.0 || matrix.xy != 0.0 || matrix.yx != 0.0)
+    return FALSE;
+
+  cairo_surface_get_device_scale (cairo_get_target (cr), &xscale, &yscale);
+  if (xscale != yscale || xscale != (gint) xscale ||
+      xscale < 1 || xscale > ATLAS_MAX_SCALE)
+    return FALSE;
+
+  x = y = 0;
+  cairo_user_to_device (cr, &x, &y);
+  if (x != floor (x) || y != floor (y))
+    return FALSE;
+
+  key.type = image_type;
+  key.width = width;
+  key.height = height;
+  key.fg_color = builtin->fg_color;
+  key.bg_color = builtin->bg_color;
+
+  atlas = atlas_get (xscale);
+  entry = atlas_lookup (atlas, image, &key);
+  if (entry == NULL)
+    return FALSE;
+
+  cairo_save (cr);
+  cairo_rectangle (cr, 0, 0, width, height);
+  cairo_set_source_surface (cr, atlas->surface,
+                            - (double) entry->x / atlas->scale,
+                            - (double) entry->y / atlas->scale);
+  cairo_fill (cr);
+  cairo_restore (cr);
+
+  return TRUE;
+}
+
+void
+ctk_css_image_builtin_draw (CtkCssImage            *image,
+                            cairo_t                *cr,
+                            double                  width,
+                            double                  height,
+                            CtkCssImageBuiltinType  image_type)
+{
+  if (!CTK_IS_CSS_IMAGE_BUILTIN (image))
+    {
+      _ctk_css_image_draw (image, cr, width, height);
+      return;
+    }
+
+  if (image_type == CTK_CSS_IMAGE_BUILTIN_NONE)
+    return;
+
+  if (atlas_enabled () &&
+      ctk_css_image_builtin_draw_from_atlas (image, cr, width, height, image_type))
+    return;
+
+  ctk_css_image_builtin_draw_uncached (image, cr, width, height, image_type);
+}
@@ -22,12 +22,15 @@
 #include "ctkcssimagelinearprivate.h"
 
 #include <math.h>
+#include <string.h>
 
 #include "ctkcsscolorvalueprivate.h"
 #include "ctkcssnumbervalueprivate.h"
 #include "ctkcssrgbavalueprivate.h"
 #include "ctkcssprovider.h"
 
+#include "ctkprofilerprivate.h"
+
 G_DEFINE_TYPE (CtkCssImageLinear, _ctk_css_image_linear, CTK_TYPE_CSS_IMAGE)
 
 static void
@@ -127,20 +130,12 @@ ctk_css_image_linear_compute_start_point (double angle_in_degrees,
   *y = perpendicular * *x + c;
 }
                                          
-static void
-ctk_css_image_linear_draw (CtkCssImage        *image,
-                           cairo_t            *cr,
-                           double              width,
-                           double              height)
+static double
+ctk_css_image_linear_get_angle (CtkCssImageLinear *linear,
+                                double             width,
+                                double             height)
 {
-  CtkCssImageLinear *linear = CTK_CSS_IMAGE_LINEAR (image);
-  cairo_pattern_t *pattern;
-  double angle; /* actual angle of the gradiant line in degrees */
-  double x, y; /* coordinates of start point */
-  double length; /* distance in pixels for 100% */
-  double start, end; /* position of first/last point on gradient line - with gradient line being [0, 1] */
-  double offset;
-  int i, last;
+  double angle;
 
   if (linear->side)
     {
@@ -171,6 +166,23 @@ ctk_css_image_linear_draw (CtkCssImage        *image,
       angle = _ctk_css_number_value_get (linear->angle, 100);
     }
 
+  return angle;
+}
+
+/* Creates the gradient for a width x height box, centered on the origin */
+static cairo_pattern_t *
+ctk_css_image_linear_create_pattern (CtkCssImageLinear *linear,
+                                     double             angle,
+                                     double             width,
+                                     double             height)
+{
+  cairo_pattern_t *pattern;
+  double x, y; /* coordinates of start point */
+  double length; /* distance in pixels for 100% */
+  double start, end; /* position of first/last point on gradient line - with gradient line being [0, 1] */
+  double offset;
+  int i, last;
+
   ctk_css_image_linear_compute_start_point (angle,
                                             width, height,
                                             &x, &y);
@@ -228,6 +240,254 @@ ctk_css_image_linear_draw (CtkCssImage        *image,
       last = i;
     }
 
+  return pattern;
+}
+
+static void
+update_cache_counters (gboolean hit)
+{
+  static guint hits_counter = 0;
+  static guint misses_counter = 0;
+  static gint64 hits = 0;
+  static gint64 misses = 0;
+
+  if (hit)
+    hits++;
+  else
+    misses++;
+
+  if (!CTK_PROFILER_IS_RUNNING)
+    return;
+
+  if (hit)
+    ctk_profiler_set_int_counter (&hits_counter, "gradient-cache-hits",
+                                  "Gradients drawn from a cached strip", hits);
+  else
+    ctk_profiler_set_int_counter (&misses_counter, "gradient-cache-misses",
+                                  "Gradient strips rasterized", misses);
+}
+
+/* Returns the device scale if drawing a width x height box on @cr
+ * covers whole device pixels of a raster surface, or 0 otherwise.
+ */
+static int
+get_pixel_aligned_scale (cairo_t *cr,
+                         double   width,
+                         double   height)
+{
+  cairo_matrix_t matrix;
+  double xscale, yscale;
+  double x, y;
+
+  if (_ctk_css_image_target_is_vector (cr))
+    return 0;
+
+  if (width != floor (width) || height != floor (height))
+    return 0;
+
+  cairo_get_matrix (cr, &matrix);
+  if (matrix.xx != 1.0 || matrix.yy != 1.0 || matrix.xy != 0.0 || matrix.yx != 0.0)
+    return 0;
+
+  cairo_surface_get_device_scale (cairo_get_target (cr), &xscale, &yscale);
+  if (xscale != yscale || xscale != floor (xscale) || xscale < 1)
+    return 0;
+
+  x = y = 0;
+  cairo_user_to_device (cr, &x, &y);
+  if (x != floor (x) || y != floor (y))
+    return 0;
+
+  return xscale;
+}
+
+/* Horizontal and vertical gradients only vary along one axis, and
+ * are by far the most common in themes. For those, we rasterize a
+ * one pixel wide strip once and stretch it over the box, which gives
+ * the same pixels as long as the box is aligned to the pixel grid.
+ *
+ * The same gradient is usually drawn at several lengths per frame,
+ * and by widgets with separately computed but equal images, so the
+ * strips are kept in a small cache shared by all linear gradients,
+ * most recently used first.
+ */
+#define STRIP_CACHE_SIZE 8
+
+/* The largest image surface cairo will create */
+#define STRIP_MAX_LENGTH 32767
+
+typedef struct {
+  CtkCssImage *image;
+  guint vertical :1;
+  int length;
+  int scale;
+  cairo_surface_t *strip;
+} StripCacheEntry;
+
+static StripCacheEntry strip_cache[STRIP_CACHE_SIZE];
+static guint n_strips = 0;
+
+static cairo_surface_t *
+strip_cache_lookup (CtkCssImageLinear *linear,
+                    gboolean           vertical,
+                    int                length,
+                    int                scale)
+{
+  StripCacheEntry entry;
+  guint i;
+
+  for (i = 0; i < n_strips; i++)
+    {
+      if (strip_cache[i].vertical != vertical ||
+          strip_cache[i].length != length ||
+          strip_cache[i].scale != scale)
+        continue;
+
+      if (strip_cache[i].image != CTK_CSS_IMAGE (linear) &&
+          !_ctk_css_image_equal (strip_cache[i].image, CTK_CSS_IMAGE (linear)))
+        continue;
+
+      entry = strip_cache[i];
+      memmove (&strip_cache[1], &strip_cache[0], i * sizeof (StripCacheEntry));
+      strip_cache[0] = entry;
+
+      return entry.strip;
+    }
+
+  return NULL;
+}
+
+static void
+strip_cache_insert (CtkCssImageLinear *linear,
+                    gboolean           vertical,
+                    int                length,
+                    int                scale,
+                    cairo_surface_t   *strip)
+{
+  if (n_strips == STRIP_CACHE_SIZE)
+    {
+      n_strips--;
+      g_object_unref (strip_cache[n_strips].image);
+      cairo_surface_destroy (strip_cache[n_strips].strip);
+    }
+
+  memmove (&strip_cache[1], &strip_cache[0], n_strips * sizeof (StripCacheEntry));
+  n_strips++;
+
+  strip_cache[0].image = g_object_ref (CTK_CSS_IMAGE (linear));
+  strip_cache[0].vertical = vertical;
+  strip_cache[0].length = length;
+  strip_cache[0].scale = scale;
+  strip_cache[0].strip = strip;
+}
+
+static cairo_surface_t *
+ctk_css_image_linear_get_strip (CtkCssImageLinear *linear,
+                                cairo_t           *cr,
+                                double             angle,
+                                double             width,
+                                double             height)
+{
+  cairo_pattern_t *pattern;
+  cairo_surface_t *strip;
+  cairo_t *strip_cr;
+  gboolean vertical;
+  int length, scale;
+
+  angle = fmod (angle, 360);
+  if (angle < 0)
+    angle += 360;
+
+  if (angle == 0 || angle == 180)
+    vertical = TRUE;
+  else if (angle == 90 || angle == 270)
+    vertical = FALSE;
+  else
+    return NULL;
+
+  scale = get_pixel_aligned_scale (cr, width, height);
+  if (scale == 0)
+    return NULL;
+
+  length = vertical ? height : width;
+
+  /* Longer gradients are rare enough to just be painted directly */
+  if ((gint64) length * scale > STRIP_MAX_LENGTH)
+    return NULL;
+
+  strip = strip_cache_lookup (linear, vertical, length, scale);
+  if (strip)
+    {
+      update_cache_counters (TRUE);
+      return strip;
+    }
+
+  if (vertical)
+    strip = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 1, length * scale);
+  else
+    strip = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, length * scale, 1);
+
+  if (cairo_surface_status (strip) != CAIRO_STATUS_SUCCESS)
+    {
+      cairo_surface_destroy (strip);
+      return NULL;
+    }
+
+  cairo_surface_set_device_scale (strip, scale, scale);
+
+  /* The gradient only depends on the size along its axis */
+  pattern = ctk_css_image_linear_create_pattern (linear, angle,
+                                                 vertical ? 1 : width,
+                                                 vertical ? height : 1);
+
+  strip_cr = cairo_create (strip);
+  if (vertical)
+    cairo_translate (strip_cr, 0, height / 2);
+  else
+    cairo_translate (strip_cr, width / 2, 0);
+  cairo_set_source (strip_cr, pattern);
+  cairo_paint (strip_cr);
+  cairo_destroy (strip_cr);
+
+  cairo_pattern_destroy (pattern);
+
+  strip_cache_insert (linear, vertical, length, scale, strip);
+
+  update_cache_counters (FALSE);
+
+  return strip;
+}
+
+static void
+ctk_css_image_linear_draw (CtkCssImage        *image,
+                           cairo_t            *cr,
+                           double              width,
+                           double              height)
+{
+  CtkCssImageLinear *linear = CTK_CSS_IMAGE_LINEAR (image);
+  cairo_pattern_t *pattern;
+  cairo_surface_t *strip;
+  double angle; /* actual angle of the gradiant line in degrees */
+
+  angle = ctk_css_image_linear_get_angle (linear, width, height);
+
+  strip = ctk_css_image_linear_get_strip (linear, cr, angle, width, height);
+  if (strip)
+    {
+      pattern = cairo_pattern_create_for_surface (strip);
+      cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
+      cairo_pattern_set_filter (pattern, CAIRO_FILTER_NEAREST);
+
+      cairo_rectangle (cr, 0, 0, width, height);
+      cairo_set_source (cr, pattern);
+      cairo_fill (cr);
+
+      cairo_pattern_destroy (pattern);
+      return;
+    }
+
+  pattern = ctk_css_image_linear_create_pattern (linear, angle, width, height);
+
   cairo_rectangle (cr, 0, 0, width, height);
   cairo_translate (cr, width / 2, height / 2);
   cairo_set_source (cr, pattern);
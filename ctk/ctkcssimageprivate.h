@@ -123,6 +123,8 @@ cairo_surface_t *
                                                     int                         surface_width,
                                                     int                         surface_height);
 
+gboolean       _ctk_css_image_target_is_vector     (cairo_t                    *cr);
+
 G_END_DECLS
 
 #endif /* __CTK_CSS_IMAGE_PRIVATE_H__ */
@@ -27,6 +27,106 @@
 
 G_DEFINE_TYPE (CtkCssImageUrl, _ctk_css_image_url, CTK_TYPE_CSS_IMAGE)
 
+/* Decoded images, shared between all CtkCssImageUrl values that refer
+ * to the same file, so that reloading a theme or several providers
+ * using the same image don't decode it again. The table does not keep
+ * the surfaces alive; an entry is removed when its surface is destroyed.
+ */
+typedef struct
+{
+  GFile *file;
+  guint64 mtime;
+  cairo_surface_t *surface;
+} CachedSurface;
+
+static GHashTable *surface_cache = NULL;
+static const cairo_user_data_key_t cached_surface_key;
+
+static void
+cached_surface_free (gpointer data)
+{
+  CachedSurface *cached = data;
+
+  g_object_unref (cached->file);
+  g_slice_free (CachedSurface, cached);
+}
+
+static void
+cached_surface_destroyed (gpointer data)
+{
+  CachedSurface *cached = data;
+
+  /* The entry may have been replaced by a newer version of the file */
+  if (g_hash_table_lookup (surface_cache, cached->file) == cached)
+    g_hash_table_remove (surface_cache, cached->file);
+  else
+    cached_surface_free (cached);
+}
+
+static guint64
+get_file_mtime (GFile *file)
+{
+  GFileInfo *info;
+  guint64 mtime;
+
+  if (!g_file_is_native (file))
+    return 0;
+
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                            G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  if (info == NULL)
+    return 0;
+
+  mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  g_object_unref (info);
+
+  return mtime;
+}
+
+static cairo_surface_t *
+lookup_cached_surface (GFile   *file,
+                       guint64  mtime)
+{
+  CachedSurface *cached;
+
+  if (surface_cache == NULL)
+    return NULL;
+
+  cached = g_hash_table_lookup (surface_cache, file);
+  if (cached == NULL || cached->mtime != mtime)
+    return NULL;
+
+  return cairo_surface_reference (cached->surface);
+}
+
+static void
+add_cached_surface (GFile           *file,
+                    guint64          mtime,
+                    cairo_surface_t *surface)
+{
+  CachedSurface *cached;
+
+  if (surface_cache == NULL)
+    surface_cache = g_hash_table_new_full ((GHashFunc) g_file_hash,
+                                           (GEqualFunc) g_file_equal,
+                                           NULL,
+                                           cached_surface_free);
+
+  cached = g_slice_new (CachedSurface);
+  cached->file = g_object_ref (file);
+  cached->mtime = mtime;
+  cached->surface = surface;
+
+  /* An outdated entry stays alive until its surface goes away,
+   * see cached_surface_destroyed().
+   */
+  g_hash_table_steal (surface_cache, file);
+  g_hash_table_insert (surface_cache, cached->file, cached);
+
+  cairo_surface_set_user_data (surface, &cached_surface_key,
+                               cached, cached_surface_destroyed);
+}
+
 static CtkCssImage *
 ctk_css_image_url_load_image (CtkCssImageUrl  *url,
                               GError         **error)
@@ -34,10 +134,21 @@ ctk_css_image_url_load_image (CtkCssImageUrl  *url,
   GdkPixbuf *pixbuf;
   GError *local_error = NULL;
   GFileInputStream *input;
+  cairo_surface_t *surface;
+  guint64 mtime;
 
   if (url->loaded_image)
     return url->loaded_image;
 
+  mtime = get_file_mtime (url->file);
+  surface = lookup_cached_surface (url->file, mtime);
+  if (surface)
+    {
+      url->loaded_image = _ctk_css_image_surface_new (surface);
+      cairo_surface_destroy (surface);
+      return url->loaded_image;
+    }
+
   /* We special case resources here so we can use
      gdk_pixbuf_new_from_resource, which in turn has some special casing
      for GdkPixdata files to avoid duplicating the memory for the pixbufs */
@@ -87,9 +198,14 @@ ctk_css_image_url_load_image (CtkCssImageUrl  *url,
       return url->loaded_image;
     }
 
-  url->loaded_image = _ctk_css_image_surface_new_for_pixbuf (pixbuf);
+  surface = cdk_cairo_surface_create_from_pixbuf (pixbuf, 1, NULL);
   g_object_unref (pixbuf);
 
+  add_cached_surface (url->file, mtime, surface);
+
+  url->loaded_image = _ctk_css_image_surface_new (surface);
+  cairo_surface_destroy (surface);
+
   return url->loaded_image;
 }
 
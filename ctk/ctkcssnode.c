@@ -23,6 +23,7 @@
 #include "ctkcsssectionprivate.h"
 #include "ctkcssstylepropertyprivate.h"
 #include "ctkintl.h"
+#include "ctkprofilerprivate.h"
 #include "ctkmarshalers.h"
 #include "ctksettingsprivate.h"
 #include "ctktypebuiltins.h"
@@ -352,6 +353,33 @@ store_in_global_parent_cache (CtkCssNode                  *node,
                                                  style);
 }
 
+static void
+update_style_counters (gboolean cached)
+{
+  static guint hits_counter = 0;
+  static guint computed_counter = 0;
+  static gint64 hits = 0;
+  static gint64 computed = 0;
+
+  if (cached)
+    hits++;
+  else
+    computed++;
+
+  if (ctk_profiler_collecting)
+    ctk_profiler_count_style (cached);
+
+  if (!CTK_PROFILER_IS_RUNNING)
+    return;
+
+  if (cached)
+    ctk_profiler_set_int_counter (&hits_counter, "css-style-cache-hits",
+                                  "Styles reused from the parent's style cache", hits);
+  else
+    ctk_profiler_set_int_counter (&computed_counter, "css-styles-computed",
+                                  "Styles computed from the style sheets", computed);
+}
+
 static CtkCssStyle *
 ctk_css_node_create_style (CtkCssNode *cssnode)
 {
@@ -364,6 +392,7 @@ ctk_css_node_create_style (CtkCssNode *cssnode)
   parent = cssnode->parent ? cssnode->parent->style : NULL;
 
   style = lookup_in_global_parent_cache (cssnode, decl);
+  update_style_counters (style != NULL);
   if (style)
     return g_object_ref (style);
 
@@ -1403,10 +1432,15 @@ void
 ctk_css_node_validate (CtkCssNode *cssnode)
 {
   gint64 timestamp;
+  gint64 before;
+
+  before = CTK_PROFILER_CURRENT_TIME;
 
   timestamp = ctk_css_node_get_timestamp (cssnode);
 
   ctk_css_node_validate_internal (cssnode, timestamp);
+
+  ctk_profiler_end_mark (before, "css validation", "");
 }
 
 gboolean
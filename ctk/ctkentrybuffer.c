@@ -76,6 +76,12 @@ struct _CtkEntryBufferPrivate
   gsize  normal_text_bytes;
   guint  normal_text_chars;
 
+  /* A known character/byte offset pair, normally the end of the last
+   * edit, so that edits near it do not walk the text from the start.
+   */
+  guint  anchor_char;
+  gsize  anchor_byte;
+
   gint   max_length;
 };
 
@@ -99,6 +105,54 @@ trash_area (gchar *area,
     *varea++ = 0;
 }
 
+/* Converts a character offset into a byte offset, walking from
+ * whichever of the start, the end or the cached anchor is closest.
+ */
+static gsize
+ctk_entry_buffer_normal_offset_to_byte (CtkEntryBufferPrivate *pv,
+                                        guint                  position)
+{
+  const gchar *from;
+  gint offset;
+  guint dist_start, dist_end, dist_anchor;
+
+  if (position == 0)
+    return 0;
+  if (position >= pv->normal_text_chars)
+    return pv->normal_text_bytes;
+
+  dist_start = position;
+  dist_end = pv->normal_text_chars - position;
+  dist_anchor = ABS ((gint) position - (gint) pv->anchor_char);
+
+  if (dist_anchor <= dist_start && dist_anchor <= dist_end)
+    {
+      from = pv->normal_text + pv->anchor_byte;
+      offset = (gint) position - (gint) pv->anchor_char;
+    }
+  else if (dist_start <= dist_end)
+    {
+      from = pv->normal_text;
+      offset = position;
+    }
+  else
+    {
+      from = pv->normal_text + pv->normal_text_bytes;
+      offset = - (gint) dist_end;
+    }
+
+  return g_utf8_offset_to_pointer (from, offset) - pv->normal_text;
+}
+
+static void
+ctk_entry_buffer_normal_set_anchor (CtkEntryBufferPrivate *pv,
+                                    guint                  position,
+                                    gsize                  byte)
+{
+  pv->anchor_char = position;
+  pv->anchor_byte = byte;
+}
+
 static const gchar*
 ctk_entry_buffer_normal_get_text (CtkEntryBuffer *buffer,
                                   gsize          *n_bytes)
@@ -168,7 +222,7 @@ ctk_entry_buffer_normal_insert_text (CtkEntryBuffer *buffer,
     }
 
   /* Actual text insertion */
-  at = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
+  at = ctk_entry_buffer_normal_offset_to_byte (pv, position);
   memmove (pv->normal_text + at + n_bytes, pv->normal_text + at, pv->normal_text_bytes - at);
   memcpy (pv->normal_text + at, chars, n_bytes);
 
@@ -176,6 +230,7 @@ ctk_entry_buffer_normal_insert_text (CtkEntryBuffer *buffer,
   pv->normal_text_bytes += n_bytes;
   pv->normal_text_chars += n_chars;
   pv->normal_text[pv->normal_text_bytes] = '\0';
+  ctk_entry_buffer_normal_set_anchor (pv, position + n_chars, at + n_bytes);
 
   ctk_entry_buffer_emit_inserted_text (buffer, position, chars, n_chars);
   return n_chars;
@@ -196,8 +251,9 @@ ctk_entry_buffer_normal_delete_text (CtkEntryBuffer *buffer,
 
   if (n_chars > 0)
     {
-      start = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
-      end = g_utf8_offset_to_pointer (pv->normal_text, position + n_chars) - pv->normal_text;
+      start = ctk_entry_buffer_normal_offset_to_byte (pv, position);
+      ctk_entry_buffer_normal_set_anchor (pv, position, start);
+      end = ctk_entry_buffer_normal_offset_to_byte (pv, position + n_chars);
 
       memmove (pv->normal_text + start, pv->normal_text + end, pv->normal_text_bytes + 1 - end);
       pv->normal_text_chars -= n_chars;
@@ -254,6 +310,8 @@ ctk_entry_buffer_init (CtkEntryBuffer *buffer)
   pv->normal_text_chars = 0;
   pv->normal_text_bytes = 0;
   pv->normal_text_size = 0;
+  pv->anchor_char = 0;
+  pv->anchor_byte = 0;
 }
 
 static void
@@ -269,6 +327,8 @@ ctk_entry_buffer_finalize (GObject *obj)
       pv->normal_text = NULL;
       pv->normal_text_bytes = pv->normal_text_size = 0;
       pv->normal_text_chars = 0;
+      pv->anchor_char = 0;
+      pv->anchor_byte = 0;
     }
 
   G_OBJECT_CLASS (ctk_entry_buffer_parent_class)->finalize (obj);
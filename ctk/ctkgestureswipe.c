@@ -41,6 +41,7 @@
 #include "ctkgestureprivate.h"
 #include "ctkmarshalers.h"
 #include "ctkintl.h"
+#include "cdk/cdk-private.h"
 #include "ctkmarshalers.h"
 
 #define CAPTURE_THRESHOLD_MS 150
@@ -130,17 +131,41 @@ ctk_gesture_swipe_append_event (CtkGestureSwipe  *swipe,
                                 CdkEventSequence *sequence)
 {
   CtkGestureSwipePrivate *priv;
+  const CdkEventHistory *history;
+  const CdkEvent *event;
   EventData new;
   gdouble x, y;
+  gdouble event_x, event_y;
+  guint i, n_history;
 
   priv = ctk_gesture_swipe_get_instance_private (swipe);
   _ctk_gesture_get_last_update_time (CTK_GESTURE (swipe), sequence, &new.evtime);
   ctk_gesture_get_point (CTK_GESTURE (swipe), sequence, &x, &y);
 
+  _ctk_gesture_swipe_clear_backlog (swipe, new.evtime);
+
+  /* Take in the positions that event compression folded into the
+   * last event, they are relative to the same window as the event.
+   */
+  event = ctk_gesture_get_last_event (CTK_GESTURE (swipe), sequence);
+  if (event && cdk_event_get_coords (event, &event_x, &event_y))
+    {
+      history = CDK_PRIVATE_CALL (cdk_event_get_history) (event, &n_history);
+
+      for (i = 0; i < n_history; i++)
+        {
+          EventData past;
+
+          past.evtime = history[i].time;
+          past.point.x = x + history[i].x - event_x;
+          past.point.y = y + history[i].y - event_y;
+          g_array_append_val (priv->events, past);
+        }
+    }
+
   new.point.x = x;
   new.point.y = y;
 
-  _ctk_gesture_swipe_clear_backlog (swipe, new.evtime);
   g_array_append_val (priv->events, new);
 }
 
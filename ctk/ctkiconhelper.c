@@ -43,15 +43,50 @@ struct _CtkIconHelperPrivate {
   guint use_fallback : 1;
   guint force_scale_pixbuf : 1;
   guint rendered_surface_is_symbolic : 1;
+  guint load_pending : 1;
+  guint load_pending_is_symbolic : 1;
+  guint force_sync_load : 1;
+  guint in_ensure_surface : 1;
+
+  /* Bumped whenever the rendered surface is invalidated, so that
+   * asynchronous loads started for an older state can be discarded.
+   */
+  guint load_serial;
 
   cairo_surface_t *rendered_surface;
 };
 
+/* An icon load running in a worker thread, shared by all helpers that
+ * asked for the same icon info and colors while it was in flight.
+ */
+typedef struct
+{
+  CtkIconInfo *info;
+  gboolean symbolic;
+  CdkRGBA fg;
+  CdkRGBA success_color;
+  CdkRGBA warning_color;
+  CdkRGBA error_color;
+  GSList *waiters;
+} PendingIconLoad;
+
+typedef struct
+{
+  GWeakRef helper;
+  guint serial;
+  gint scale;
+} PendingIconWaiter;
+
+static GHashTable *pending_icon_loads = NULL;
+
 G_DEFINE_TYPE_WITH_PRIVATE (CtkIconHelper, ctk_icon_helper, CTK_TYPE_CSS_GADGET)
 
 static void
 ctk_icon_helper_invalidate (CtkIconHelper *self)
 {
+  self->priv->load_serial++;
+  self->priv->load_pending = FALSE;
+
   if (self->priv->rendered_surface != NULL)
     {
       cairo_surface_destroy (self->priv->rendered_surface);
@@ -68,12 +103,21 @@ ctk_icon_helper_invalidate_for_change (CtkIconHelper     *self,
                                        CtkCssStyleChange *change)
 {
   CtkIconHelperPrivate *priv = self->priv;
+  gboolean symbolic;
+
+  /* A pending load was started with the colors of the old style, so it
+   * needs to be discarded just like a surface rendered with them.
+   */
+  if (priv->load_pending)
+    symbolic = priv->load_pending_is_symbolic;
+  else
+    symbolic = priv->rendered_surface_is_symbolic;
 
   if (change == NULL ||
       ((ctk_css_style_change_affects (change, CTK_CSS_AFFECTS_SYMBOLIC_ICON) &&
-        priv->rendered_surface_is_symbolic) ||
+        symbolic) ||
        (ctk_css_style_change_affects (change, CTK_CSS_AFFECTS_ICON) &&
-        !priv->rendered_surface_is_symbolic)))
+        !symbolic)))
     {
       ctk_icon_helper_invalidate (self);
     }
@@ -90,6 +134,7 @@ ctk_icon_helper_take_definition (CtkIconHelper      *self,
 
   ctk_image_definition_unref (self->priv->def);
   self->priv->def = def;
+  self->priv->force_sync_load = FALSE;
 
   ctk_icon_helper_invalidate (self);
 }
@@ -427,6 +472,234 @@ ensure_surface_for_icon_set (CtkIconHelper    *self,
   return surface;
 }
 
+static gboolean
+async_icon_loading_enabled (void)
+{
+  static gint enabled = -1;
+
+  if (enabled == -1)
+    enabled = g_strcmp0 (g_getenv ("CTK_ASYNC_ICON_LOADING"), "1") == 0;
+
+  return enabled;
+}
+
+/* Whether the icon for @self may be loaded in a thread. We only do this
+ * when the size of the helper does not depend on the loaded icon, and
+ * when the helper is long-lived; transient helpers (as used by cell
+ * renderers) are recreated for every draw and would never see the
+ * result.
+ */
+static gboolean
+ctk_icon_helper_can_load_async (CtkIconHelper *self)
+{
+  CtkIconHelperPrivate *priv = self->priv;
+
+  /* ctk_icon_helper_load_surface() callers expect a surface */
+  if (!priv->in_ensure_surface)
+    return FALSE;
+
+  if (!async_icon_loading_enabled () || priv->force_sync_load)
+    return FALSE;
+
+  if (CTK_IS_CSS_TRANSIENT_NODE (ctk_css_gadget_get_node (CTK_CSS_GADGET (self))))
+    return FALSE;
+
+  return priv->pixel_size != -1 || priv->icon_size != CTK_ICON_SIZE_INVALID;
+}
+
+static guint
+pending_icon_load_hash (gconstpointer data)
+{
+  const PendingIconLoad *load = data;
+  guint hash = g_direct_hash (load->info);
+
+  if (load->symbolic)
+    hash ^= cdk_rgba_hash (&load->fg);
+
+  return hash;
+}
+
+static gboolean
+pending_icon_load_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  const PendingIconLoad *load_a = a;
+  const PendingIconLoad *load_b = b;
+
+  if (load_a->info != load_b->info || load_a->symbolic != load_b->symbolic)
+    return FALSE;
+
+  if (!load_a->symbolic)
+    return TRUE;
+
+  return cdk_rgba_equal (&load_a->fg, &load_b->fg) &&
+         cdk_rgba_equal (&load_a->success_color, &load_b->success_color) &&
+         cdk_rgba_equal (&load_a->warning_color, &load_b->warning_color) &&
+         cdk_rgba_equal (&load_a->error_color, &load_b->error_color);
+}
+
+static void
+pending_icon_waiter_free (gpointer data)
+{
+  PendingIconWaiter *waiter = data;
+
+  g_weak_ref_clear (&waiter->helper);
+  g_slice_free (PendingIconWaiter, waiter);
+}
+
+static cairo_surface_t *
+surface_for_loaded_icon (CtkIconHelper *self,
+                         CtkCssStyle   *style,
+                         gint           scale,
+                         GdkPixbuf     *destination,
+                         gboolean       symbolic)
+{
+  cairo_surface_t *surface;
+
+  surface = cdk_cairo_surface_create_from_pixbuf (destination, scale, ctk_widget_get_window (ctk_css_gadget_get_owner (CTK_CSS_GADGET (self))));
+
+  if (!symbolic)
+    {
+      CtkCssIconEffect icon_effect;
+
+      icon_effect = _ctk_css_icon_effect_value_get (ctk_css_style_get_value (style, CTK_CSS_PROPERTY_ICON_EFFECT));
+      ctk_css_icon_effect_apply (icon_effect, surface);
+    }
+  else
+    {
+      self->priv->rendered_surface_is_symbolic = TRUE;
+    }
+
+  return surface;
+}
+
+static void
+ctk_icon_helper_finish_load (CtkIconHelper *self,
+                             gint           scale,
+                             GdkPixbuf     *pixbuf,
+                             gboolean       symbolic)
+{
+  CtkIconHelperPrivate *priv = self->priv;
+  CtkWidget *owner;
+
+  priv->load_pending = FALSE;
+  owner = ctk_css_gadget_get_owner (CTK_CSS_GADGET (self));
+
+  if (pixbuf == NULL)
+    {
+      /* Let the synchronous path deal with fallbacks */
+      priv->force_sync_load = TRUE;
+      ctk_icon_helper_invalidate (self);
+      ctk_widget_queue_resize (owner);
+      return;
+    }
+
+  priv->rendered_surface = surface_for_loaded_icon (self,
+                                                    ctk_css_node_get_style (ctk_css_gadget_get_node (CTK_CSS_GADGET (self))),
+                                                    scale,
+                                                    pixbuf,
+                                                    symbolic);
+
+  /* The placeholder had the nominal size; the icon may differ */
+  ctk_widget_queue_resize (owner);
+}
+
+static void
+icon_loaded_cb (GObject      *source,
+                GAsyncResult *result,
+                gpointer      data)
+{
+  PendingIconLoad *load = data;
+  GdkPixbuf *pixbuf;
+  GSList *l;
+
+  if (load->symbolic)
+    pixbuf = ctk_icon_info_load_symbolic_finish (load->info, result, NULL, NULL);
+  else
+    pixbuf = ctk_icon_info_load_icon_finish (load->info, result, NULL);
+
+  g_hash_table_steal (pending_icon_loads, load);
+
+  for (l = load->waiters; l != NULL; l = l->next)
+    {
+      PendingIconWaiter *waiter = l->data;
+      CtkIconHelper *self;
+
+      self = g_weak_ref_get (&waiter->helper);
+      if (self == NULL)
+        continue;
+
+      if (self->priv->load_serial == waiter->serial &&
+          self->priv->rendered_surface == NULL)
+        ctk_icon_helper_finish_load (self, waiter->scale, pixbuf, load->symbolic);
+
+      g_object_unref (self);
+    }
+
+  g_clear_object (&pixbuf);
+  g_slist_free_full (load->waiters, pending_icon_waiter_free);
+  g_object_unref (load->info);
+  g_slice_free (PendingIconLoad, load);
+}
+
+/* Starts loading @info in a worker thread, or joins a load of the same
+ * icon that is already in flight, and arranges for the rendered surface
+ * of @self to be set when it finishes.
+ */
+static void
+ctk_icon_helper_load_async (CtkIconHelper *self,
+                            CtkIconInfo   *info,
+                            gint           scale,
+                            gboolean       symbolic,
+                            const CdkRGBA *fg,
+                            const CdkRGBA *success_color,
+                            const CdkRGBA *warning_color,
+                            const CdkRGBA *error_color)
+{
+  PendingIconLoad lookup = { 0, };
+  PendingIconLoad *load;
+  PendingIconWaiter *waiter;
+
+  if (pending_icon_loads == NULL)
+    pending_icon_loads = g_hash_table_new (pending_icon_load_hash, pending_icon_load_equal);
+
+  lookup.info = info;
+  lookup.symbolic = symbolic;
+  if (symbolic)
+    {
+      lookup.fg = *fg;
+      lookup.success_color = *success_color;
+      lookup.warning_color = *warning_color;
+      lookup.error_color = *error_color;
+    }
+
+  load = g_hash_table_lookup (pending_icon_loads, &lookup);
+  if (load == NULL)
+    {
+      load = g_slice_dup (PendingIconLoad, &lookup);
+      g_object_ref (load->info);
+      g_hash_table_add (pending_icon_loads, load);
+
+      if (symbolic)
+        ctk_icon_info_load_symbolic_async (info,
+                                           fg, success_color,
+                                           warning_color, error_color,
+                                           NULL,
+                                           icon_loaded_cb, load);
+      else
+        ctk_icon_info_load_icon_async (info, NULL, icon_loaded_cb, load);
+    }
+
+  waiter = g_slice_new (PendingIconWaiter);
+  g_weak_ref_init (&waiter->helper, self);
+  waiter->serial = self->priv->load_serial;
+  waiter->scale = scale;
+  load->waiters = g_slist_prepend (load->waiters, waiter);
+
+  self->priv->load_pending = TRUE;
+  self->priv->load_pending_is_symbolic = symbolic;
+}
+
 static cairo_surface_t *
 ensure_surface_for_gicon (CtkIconHelper    *self,
                           CtkCssStyle      *style,
@@ -434,7 +707,7 @@ ensure_surface_for_gicon (CtkIconHelper    *self,
                           gint              scale,
                           GIcon            *gicon)
 {
-  CtkIconHelperPrivate *priv = self->priv;
+  CdkRGBA fg, success_color, warning_color, error_color;
   CtkIconTheme *icon_theme;
   gint width, height;
   CtkIconInfo *info;
@@ -458,11 +731,24 @@ ensure_surface_for_gicon (CtkIconHelper    *self,
       symbolic = ctk_icon_info_is_symbolic (info);
 
       if (symbolic)
+        ctk_icon_theme_lookup_symbolic_colors (style, &fg, &success_color, &warning_color, &error_color);
+
+      /* Don't block drawing on disk access or SVG rendering; leave the
+       * space empty until the icon is ready.
+       */
+      if (ctk_icon_helper_can_load_async (self) &&
+          !ctk_icon_info_is_loaded (info,
+                                    symbolic ? &fg : NULL,
+                                    &success_color, &warning_color, &error_color))
         {
-          CdkRGBA fg, success_color, warning_color, error_color;
-
-          ctk_icon_theme_lookup_symbolic_colors (style, &fg, &success_color, &warning_color, &error_color);
+          ctk_icon_helper_load_async (self, info, scale, symbolic,
+                                      &fg, &success_color, &warning_color, &error_color);
+          g_object_unref (info);
+          return NULL;
+        }
 
+      if (symbolic)
+        {
           destination = ctk_icon_info_load_symbolic (info,
                                                      &fg, &success_color,
                                                      &warning_color, &error_color,
@@ -496,19 +782,7 @@ ensure_surface_for_gicon (CtkIconHelper    *self,
       symbolic = FALSE;
     }
 
-  surface = cdk_cairo_surface_create_from_pixbuf (destination, scale, ctk_widget_get_window (ctk_css_gadget_get_owner (CTK_CSS_GADGET (self))));
-
-  if (!symbolic)
-    {
-      CtkCssIconEffect icon_effect;
-
-      icon_effect = _ctk_css_icon_effect_value_get (ctk_css_style_get_value (style, CTK_CSS_PROPERTY_ICON_EFFECT));
-      ctk_css_icon_effect_apply (icon_effect, surface);
-    }
-  else
-    {
-      priv->rendered_surface_is_symbolic = TRUE;
-    }
+  surface = surface_for_loaded_icon (self, style, scale, destination, symbolic);
 
   g_object_unref (destination);
 
@@ -593,12 +867,14 @@ ctk_icon_helper_ensure_surface (CtkIconHelper *self)
 {
   int scale;
 
-  if (self->priv->rendered_surface)
+  if (self->priv->rendered_surface || self->priv->load_pending)
     return;
 
   scale = ctk_widget_get_scale_factor (ctk_css_gadget_get_owner (CTK_CSS_GADGET (self)));
 
+  self->priv->in_ensure_surface = TRUE;
   self->priv->rendered_surface = ctk_icon_helper_load_surface (self, scale);
+  self->priv->in_ensure_surface = FALSE;
 }
 
 void
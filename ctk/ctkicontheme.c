@@ -49,7 +49,9 @@
 #include "deprecated/ctknumerableiconprivate.h"
 #include "ctksettingsprivate.h"
 #include "ctkstylecontextprivate.h"
+#include "ctksymboliciconcacheprivate.h"
 #include "ctkprivate.h"
+#include "ctkprofilerprivate.h"
 #include "gdkpixbufutilsprivate.h"
 
 #undef CDK_DEPRECATED
@@ -182,6 +184,7 @@ struct _CtkIconThemePrivate
   guint pixbuf_supports_svg : 1;
   guint themes_valid        : 1;
   guint loading_themes      : 1;
+  guint in_batch_lookup     : 1;
 
   /* A list of all the themes needed to look up icons.
    * In search order, without duplicates
@@ -282,6 +285,13 @@ typedef struct
 
   /* In search order */
   GList *dirs;
+
+  /* theme_dir_size_difference() of each of dirs for the
+   * size and scale of the last lookup
+   */
+  gint *match_differences;
+  gint match_size;
+  gint match_scale;
 } IconTheme;
 
 typedef struct
@@ -302,6 +312,7 @@ typedef struct
   
   CtkIconCache *cache;
   
+  /* Filled in by scan_directory() on first use when there is no cache */
   GHashTable *icons;
 } IconThemeDir;
 
@@ -352,6 +363,7 @@ static gboolean     rescan_themes             (CtkIconTheme     *icon_themes);
 static IconSuffix   theme_dir_get_icon_suffix (IconThemeDir     *dir,
                                                const gchar      *icon_name,
                                                gboolean         *has_icon_file);
+static GHashTable  *theme_dir_get_icons       (IconThemeDir     *dir);
 static CtkIconInfo *icon_info_new             (IconThemeDirType  type,
                                                gint              dir_size,
                                                gint              dir_scale);
@@ -1460,6 +1472,11 @@ ensure_valid_themes (CtkIconTheme *icon_theme)
 
   if (priv->loading_themes)
     return;
+
+  /* ctk_icon_theme_lookup_icons() already validated the themes */
+  if (priv->in_batch_lookup && priv->themes_valid)
+    return;
+
   priv->loading_themes = TRUE;
 
   if (priv->themes_valid)
@@ -2242,6 +2259,68 @@ ctk_icon_theme_choose_icon_for_scale (CtkIconTheme       *icon_theme,
   return choose_icon (icon_theme, icon_names, size, scale, flags);
 }
 
+/**
+ * ctk_icon_theme_lookup_icons:
+ * @icon_theme: a #CtkIconTheme
+ * @icon_names: (array length=n_icons): array of icon names to lookup
+ * @n_icons: the number of names in @icon_names
+ * @size: desired icon size
+ * @scale: desired scale
+ * @flags: flags modifying the behavior of the icon lookup
+ *
+ * Looks up many named icons at once. This is equivalent to calling
+ * ctk_icon_theme_lookup_icon_for_scale() for each name in @icon_names,
+ * but cheaper when populating lists, menus or toolbars, since the
+ * theme is only validated once and per-size lookup data is shared
+ * between the names.
+ *
+ * Returns: (array length=n_icons) (transfer full) (element-type CtkIconInfo):
+ *     a newly allocated array of @n_icons #CtkIconInfo objects, where an
+ *     element is %NULL if the corresponding icon wasn’t found. Unref the
+ *     elements with g_object_unref() and free the array with g_free().
+ *
+ * Since: 3.25.5
+ */
+CtkIconInfo **
+ctk_icon_theme_lookup_icons (CtkIconTheme       *icon_theme,
+                             const gchar        *icon_names[],
+                             gint                n_icons,
+                             gint                size,
+                             gint                scale,
+                             CtkIconLookupFlags  flags)
+{
+  CtkIconInfo **infos;
+  gint i;
+
+  g_return_val_if_fail (CTK_IS_ICON_THEME (icon_theme), NULL);
+  g_return_val_if_fail (icon_names != NULL || n_icons == 0, NULL);
+  g_return_val_if_fail (n_icons >= 0, NULL);
+  g_return_val_if_fail ((flags & CTK_ICON_LOOKUP_NO_SVG) == 0 ||
+                        (flags & CTK_ICON_LOOKUP_FORCE_SVG) == 0, NULL);
+  g_return_val_if_fail (scale >= 1, NULL);
+
+  ensure_valid_themes (icon_theme);
+
+  infos = g_new0 (CtkIconInfo *, n_icons);
+
+  icon_theme->priv->in_batch_lookup = TRUE;
+
+  for (i = 0; i < n_icons; i++)
+    {
+      if (icon_names[i] == NULL)
+        continue;
+
+      infos[i] = ctk_icon_theme_lookup_icon_for_scale (icon_theme,
+                                                       icon_names[i],
+                                                       size, scale,
+                                                       flags);
+    }
+
+  icon_theme->priv->in_batch_lookup = FALSE;
+
+  return infos;
+}
+
 
 /* Error quark */
 GQuark
@@ -2814,6 +2893,7 @@ theme_destroy (IconTheme *theme)
   g_free (theme->example);
 
   g_list_free_full (theme->dirs, (GDestroyNotify) theme_dir_destroy);
+  g_free (theme->match_differences);
   
   g_free (theme);
 }
@@ -2958,13 +3038,87 @@ theme_dir_get_icon_suffix (IconThemeDir *dir,
       suffix = suffix & ~HAS_ICON_FILE;
     }
   else
-    suffix = GPOINTER_TO_UINT (g_hash_table_lookup (dir->icons, icon_name));
+    suffix = GPOINTER_TO_UINT (g_hash_table_lookup (theme_dir_get_icons (dir), icon_name));
 
   CTK_NOTE (ICONTHEME, g_message ("get icon suffix%s: %u", dir->cache ? " (cached)" : "", suffix));
 
   return suffix;
 }
 
+/* Returns the size difference of each directory of @theme, in the
+ * order of theme->dirs. Lookups tend to come in runs for the same
+ * size, so the result for the last size and scale is kept around.
+ */
+static const gint *
+theme_get_match_differences (IconTheme *theme,
+                             gint       size,
+                             gint       scale)
+{
+  GList *l;
+  gint i;
+
+  if (theme->match_differences != NULL &&
+      theme->match_size == size &&
+      theme->match_scale == scale)
+    return theme->match_differences;
+
+  if (theme->match_differences == NULL)
+    theme->match_differences = g_new (gint, g_list_length (theme->dirs));
+
+  for (l = theme->dirs, i = 0; l != NULL; l = l->next, i++)
+    theme->match_differences[i] = theme_dir_size_difference (l->data, size, scale);
+
+  theme->match_size = size;
+  theme->match_scale = scale;
+
+  return theme->match_differences;
+}
+
+#define N_CHECKED_CACHES 8
+
+typedef struct
+{
+  CtkIconCache *cache;
+  gboolean      has_icon;
+} CheckedCache;
+
+/* Several directories usually share one icon cache, and most names
+ * are not in most themes. Look the name up once per cache, so that
+ * misses don't cost a hash lookup for every directory.
+ */
+static gboolean
+theme_dir_may_have_icon (IconThemeDir *dir,
+                         const gchar  *icon_name,
+                         const gchar  *symbolic_png_name,
+                         CheckedCache *checked,
+                         gint         *n_checked)
+{
+  gboolean has_icon;
+  gint i;
+
+  if (dir->cache == NULL)
+    return TRUE;
+
+  for (i = 0; i < *n_checked; i++)
+    {
+      if (checked[i].cache == dir->cache)
+        return checked[i].has_icon;
+    }
+
+  has_icon = _ctk_icon_cache_has_icon (dir->cache, icon_name) ||
+             (symbolic_png_name != NULL &&
+              _ctk_icon_cache_has_icon (dir->cache, symbolic_png_name));
+
+  if (*n_checked < N_CHECKED_CACHES)
+    {
+      checked[*n_checked].cache = dir->cache;
+      checked[*n_checked].has_icon = has_icon;
+      (*n_checked)++;
+    }
+
+  return has_icon;
+}
+
 /* returns TRUE if dir_a is a better match */
 static gboolean
 compare_dir_matches (IconThemeDir *dir_a, gint difference_a,
@@ -3044,6 +3198,11 @@ theme_lookup_icon (IconTheme   *theme,
   gint min_difference, difference;
   BuiltinIcon *closest_builtin = NULL;
   IconSuffix suffix;
+  const gint *differences;
+  CheckedCache checked[N_CHECKED_CACHES];
+  gint n_checked = 0;
+  gchar *symbolic_png_name;
+  gint i;
 
   min_difference = G_MAXINT;
   min_dir = NULL;
@@ -3062,17 +3221,27 @@ theme_lookup_icon (IconTheme   *theme,
     }
 
   dirs = theme->dirs;
+  differences = theme_get_match_differences (theme, size, scale);
+
+  if (icon_name_is_symbolic (icon_name))
+    symbolic_png_name = g_strconcat (icon_name, ".symbolic", NULL);
+  else
+    symbolic_png_name = NULL;
 
   l = dirs;
+  i = 0;
   while (l != NULL)
     {
       dir = l->data;
 
       CTK_NOTE (ICONTHEME, g_message ("look up icon dir %s", dir->dir));
-      suffix = theme_dir_get_icon_suffix (dir, icon_name, NULL);
+      if (!theme_dir_may_have_icon (dir, icon_name, symbolic_png_name, checked, &n_checked))
+        suffix = ICON_SUFFIX_NONE;
+      else
+        suffix = theme_dir_get_icon_suffix (dir, icon_name, NULL);
       if (best_suffix (suffix, allow_svg) != ICON_SUFFIX_NONE)
         {
-          difference = theme_dir_size_difference (dir, size, scale);
+          difference = differences[i];
           if (min_dir == NULL ||
               compare_dir_matches (dir, difference,
                                    min_dir, min_difference,
@@ -3084,8 +3253,11 @@ theme_lookup_icon (IconTheme   *theme,
         }
 
       l = l->next;
+      i++;
     }
 
+  g_free (symbolic_png_name);
+
   if (min_dir)
     {
       CtkIconInfo *icon_info;
@@ -3157,7 +3329,7 @@ theme_list_icons (IconTheme  *theme,
           if (dir->cache)
             _ctk_icon_cache_add_icons (dir->cache, dir->subdir, icons);
           else
-            g_hash_table_foreach (dir->icons, add_key_to_hash, icons);
+            g_hash_table_foreach (theme_dir_get_icons (dir), add_key_to_hash, icons);
         }
       l = l->next;
     }
@@ -3180,7 +3352,7 @@ theme_has_icon (IconTheme   *theme,
         }
       else
         {
-          if (g_hash_table_lookup (dir->icons, icon_name) != NULL)
+          if (g_hash_table_lookup (theme_dir_get_icons (dir), icon_name) != NULL)
             return TRUE;
         }
     }
@@ -3211,22 +3383,21 @@ theme_list_contexts (IconTheme  *theme,
     }
 }
 
-static gboolean
-scan_directory (CtkIconThemePrivate *icon_theme,
-                IconThemeDir        *dir,
-                gchar               *full_dir)
+static void
+scan_directory (IconThemeDir *dir,
+                gchar        *full_dir)
 {
   GDir *gdir;
   const gchar *name;
 
   CTK_NOTE (ICONTHEME, g_message ("scanning directory %s", full_dir));
 
+  dir->icons = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
   gdir = g_dir_open (full_dir, 0, NULL);
 
   if (gdir == NULL)
-    return FALSE;
-
-  dir->icons = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    return;
 
   while ((name = g_dir_read_name (gdir)))
     {
@@ -3245,8 +3416,19 @@ scan_directory (CtkIconThemePrivate *icon_theme,
     }
   
   g_dir_close (gdir);
+}
 
-  return g_hash_table_size (dir->icons) > 0;
+/* Directories without an icon cache are only listed when an icon is
+ * first looked up in them, so that loading a theme only costs a stat()
+ * per directory and themes that are never consulted are never read.
+ */
+static GHashTable *
+theme_dir_get_icons (IconThemeDir *dir)
+{
+  if (dir->icons == NULL)
+    scan_directory (dir, dir->dir);
+
+  return dir->icons;
 }
 
 static gboolean
@@ -3398,7 +3580,8 @@ theme_subdir_load (CtkIconTheme *icon_theme,
             {
               dir->cache = NULL;
               dir->subdir_index = -1;
-              has_icons = scan_directory (icon_theme->priv, dir, full_dir);
+              /* Scanned lazily, see theme_dir_get_icons() */
+              has_icons = TRUE;
             }
 
           if (has_icons)
@@ -3852,6 +4035,7 @@ icon_info_ensure_scale_and_pixbuf (CtkIconInfo *icon_info)
   gint scaled_desired_size;
   GdkPixbuf *source_pixbuf;
   gdouble dir_scale;
+  gint64 before;
 
   if (icon_info->pixbuf)
     {
@@ -3901,6 +4085,7 @@ icon_info_ensure_scale_and_pixbuf (CtkIconInfo *icon_info)
   /* At this point, we need to actually get the icon; either from the
    * builtin image or by loading the file
    */
+  before = CTK_PROFILER_CURRENT_TIME;
   source_pixbuf = NULL;
   if (icon_info->cache_pixbuf)
     source_pixbuf = g_object_ref (icon_info->cache_pixbuf);
@@ -3969,6 +4154,8 @@ icon_info_ensure_scale_and_pixbuf (CtkIconInfo *icon_info)
         }
     }
 
+  ctk_profiler_end_mark (before, "icon load", icon_info->filename ? icon_info->filename : "");
+
   if (!source_pixbuf)
     {
       static gboolean warn_about_load_failure = TRUE;
@@ -4649,6 +4836,35 @@ ctk_icon_info_load_symbolic_internal (CtkIconInfo    *icon_info,
   icon_uri = g_file_get_uri (icon_info->icon_file);
   if (g_str_has_suffix (icon_uri, ".symbolic.png"))
     pixbuf = ctk_icon_info_load_symbolic_png (icon_info, fg, success_color, warning_color, error_color, error);
+  else if (icon_info->filename != NULL && !icon_info->is_resource)
+    {
+      CtkSymbolicIconKey key;
+
+      /* Rendering symbolic SVGs is expensive and every process does it
+       * for the same icons and colors, so share the results on disk.
+       */
+      key.filename = icon_info->filename;
+      key.dir_type = icon_info->dir_type;
+      key.dir_size = icon_info->dir_size;
+      key.dir_scale = icon_info->dir_scale;
+      key.min_size = icon_info->min_size;
+      key.max_size = icon_info->max_size;
+      key.desired_size = icon_info->desired_size;
+      key.desired_scale = icon_info->desired_scale;
+      key.forced_size = icon_info->forced_size;
+      key.fg = fg;
+      key.success_color = success_color;
+      key.warning_color = warning_color;
+      key.error_color = error_color;
+
+      pixbuf = ctk_symbolic_icon_cache_lookup (&key);
+      if (pixbuf == NULL)
+        {
+          pixbuf = ctk_icon_info_load_symbolic_svg (icon_info, fg, success_color, warning_color, error_color, error);
+          if (pixbuf != NULL)
+            ctk_symbolic_icon_cache_store (&key, pixbuf);
+        }
+    }
   else
     pixbuf = ctk_icon_info_load_symbolic_svg (icon_info, fg, success_color, warning_color, error_color, error);
 
@@ -5060,6 +5276,27 @@ ctk_icon_info_load_symbolic_finish (CtkIconInfo   *icon_info,
   return g_task_propagate_pointer (task, error);
 }
 
+/* Returns whether loading @icon_info, with the given colors if it is
+ * symbolic, would be satisfied from data already held by the icon info,
+ * i.e. would not need to touch the disk or rasterize anything.
+ */
+gboolean
+ctk_icon_info_is_loaded (CtkIconInfo   *icon_info,
+                         const CdkRGBA *fg,
+                         const CdkRGBA *success_color,
+                         const CdkRGBA *warning_color,
+                         const CdkRGBA *error_color)
+{
+  g_return_val_if_fail (CTK_IS_ICON_INFO (icon_info), FALSE);
+
+  if (fg != NULL && ctk_icon_info_is_symbolic (icon_info))
+    return symbolic_pixbuf_cache_matches (icon_info->symbolic_pixbuf_cache,
+                                          fg, success_color,
+                                          warning_color, error_color) != NULL;
+
+  return icon_info_get_pixbuf_ready (icon_info);
+}
+
 /**
  * ctk_icon_info_load_symbolic_for_context_async:
  * @icon_info: a #CtkIconInfo from ctk_icon_theme_lookup_icon()
@@ -226,6 +226,13 @@ CtkIconInfo * ctk_icon_theme_choose_icon_for_scale (CtkIconTheme
                                                     gint                         scale,
 						    CtkIconLookupFlags           flags);
 CDK_AVAILABLE_IN_ALL
+CtkIconInfo **ctk_icon_theme_lookup_icons          (CtkIconTheme                *icon_theme,
+                                                    const gchar                 *icon_names[],
+                                                    gint                         n_icons,
+                                                    gint                         size,
+                                                    gint                         scale,
+                                                    CtkIconLookupFlags           flags);
+CDK_AVAILABLE_IN_ALL
 GdkPixbuf *   ctk_icon_theme_load_icon             (CtkIconTheme                *icon_theme,
 						    const gchar                 *icon_name,
 						    gint                         size,
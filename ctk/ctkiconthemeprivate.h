@@ -37,5 +37,11 @@ GdkPixbuf * ctk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
                                                   const CdkRGBA *warning_color,
                                                   const CdkRGBA *error_color);
 
+gboolean    ctk_icon_info_is_loaded (CtkIconInfo   *icon_info,
+                                     const CdkRGBA *fg,
+                                     const CdkRGBA *success_color,
+                                     const CdkRGBA *warning_color,
+                                     const CdkRGBA *error_color);
+
 
 #endif /* __CTK_ICON_THEME_PRIVATE_H__ */
@@ -248,6 +248,19 @@
  * the #CtkLabel::activate-link signal and the ctk_label_get_current_uri() function.
  */
 
+/* Number of height-for-width results remembered per label; wrapping
+ * labels are typically probed at a handful of widths during a single
+ * size negotiation.
+ */
+#define N_CACHED_SIZES 4
+
+typedef struct
+{
+  gint width;
+  gint height;
+  gint baseline;
+} CtkLabelCachedSize;
+
 struct _CtkLabelPrivate
 {
   CtkLabelSelectionInfo *select_info;
@@ -284,6 +297,14 @@ struct _CtkLabelPrivate
   gint     width_chars;
   gint     max_width_chars;
   gint     lines;
+
+  /* Results of get_size_for_allocation(), valid as long as the layout
+   * is not cleared and the pango context serial does not change.
+   */
+  CtkLabelCachedSize cached_sizes[N_CACHED_SIZES];
+  guint    n_cached_sizes;
+  guint    next_cached_size;
+  guint    cached_sizes_serial;
 };
 
 /* Notes about the handling of links:
@@ -3306,10 +3327,18 @@ ctk_label_finalize (GObject *object)
   G_OBJECT_CLASS (ctk_label_parent_class)->finalize (object);
 }
 
+static void
+ctk_label_clear_cached_sizes (CtkLabel *label)
+{
+  label->priv->n_cached_sizes = 0;
+  label->priv->next_cached_size = 0;
+}
+
 static void
 ctk_label_clear_layout (CtkLabel *label)
 {
   g_clear_object (&label->priv->layout);
+  ctk_label_clear_cached_sizes (label);
 }
 
 /**
@@ -3530,6 +3559,7 @@ ctk_label_update_layout_attributes (CtkLabel *label)
   attrs = _ctk_pango_attr_list_merge (attrs, priv->attrs);
 
   pango_layout_set_attributes (priv->layout, attrs);
+  ctk_label_clear_cached_sizes (label);
 
   if (attrs)
     pango_attr_list_unref (attrs);
@@ -3634,24 +3664,60 @@ get_size_for_allocation (CtkLabel *label,
 			 gint     *minimum_baseline,
                          gint     *natural_baseline)
 {
+  CtkLabelPrivate *priv = label->priv;
+  CtkLabelCachedSize *cached;
   PangoLayout *layout;
   gint text_height, baseline;
+  guint serial;
+  guint i;
+
+  ctk_label_ensure_layout (label);
+
+  /* Height-for-width negotiation probes the same few widths over and
+   * over; every probe would otherwise re-wrap the whole text.
+   */
+  serial = pango_context_get_serial (pango_layout_get_context (priv->layout));
+  if (serial != priv->cached_sizes_serial)
+    {
+      ctk_label_clear_cached_sizes (label);
+      priv->cached_sizes_serial = serial;
+    }
+
+  for (i = 0; i < priv->n_cached_sizes; i++)
+    {
+      cached = &priv->cached_sizes[i];
+
+      if (cached->width == allocation)
+        {
+          text_height = cached->height;
+          baseline = cached->baseline;
+          goto out;
+        }
+    }
 
   layout = ctk_label_get_measuring_layout (label, NULL, allocation * PANGO_SCALE);
 
   pango_layout_get_pixel_size (layout, NULL, &text_height);
+  baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
+
+  g_object_unref (layout);
+
+  cached = &priv->cached_sizes[priv->next_cached_size];
+  cached->width = allocation;
+  cached->height = text_height;
+  cached->baseline = baseline;
+  priv->next_cached_size = (priv->next_cached_size + 1) % N_CACHED_SIZES;
+  priv->n_cached_sizes = MIN (priv->n_cached_sizes + 1, N_CACHED_SIZES);
 
+out:
   *minimum_size = text_height;
   *natural_size = text_height;
 
   if (minimum_baseline || natural_baseline)
     {
-      baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
       *minimum_baseline = baseline;
       *natural_baseline = baseline;
     }
-
-  g_object_unref (layout);
 }
 
 static gint
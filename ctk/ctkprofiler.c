@@ -0,0 +1,237 @@
+/* CTK - The GIMP Toolkit
+ * Copyright (C) 2026 the CTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* In-process collection of widget costs for the inspector.
+ *
+ * Widget spans can nest arbitrarily (a container's draw includes the
+ * draws of its children, an allocation may measure), but only their
+ * ends are reported. To get self times, completed spans are kept on a
+ * stack: when a span ends, every span on the stack that started after
+ * it must have been nested inside it, so those are popped and their
+ * time is subtracted before the span itself is pushed.
+ */
+
+#include "config.h"
+
+#include "ctkprofilerprivate.h"
+
+#define MAX_SPANS 1024
+#define MAX_REDRAWS 4096
+
+typedef struct
+{
+  gint64 start;
+  gint64 duration;
+} Span;
+
+gboolean ctk_profiler_collecting = FALSE;
+
+static guint collect_count = 0;
+static GArray *spans = NULL;
+static GHashTable *widget_costs = NULL;
+static GArray *redraws = NULL;
+static guint styles_computed = 0;
+static guint styles_cached = 0;
+
+static const char *mark_names[CTK_PROFILER_N_PHASES] = {
+  "size request",
+  "size allocate",
+  "widget draw"
+};
+
+static gint64
+pop_nested_spans (gint64 start,
+                  gint64 duration)
+{
+  gint64 nested = 0;
+  Span new_span;
+
+  while (spans->len > 0)
+    {
+      Span *span = &g_array_index (spans, Span, spans->len - 1);
+
+      if (span->start < start)
+        break;
+
+      nested += span->duration;
+      g_array_set_size (spans, spans->len - 1);
+    }
+
+  /* Spans that end outside of any frame never get popped by an
+   * enclosing one, so don't let them pile up.
+   */
+  if (spans->len >= MAX_SPANS)
+    g_array_set_size (spans, 0);
+
+  new_span.start = start;
+  new_span.duration = duration;
+  g_array_append_val (spans, new_span);
+
+  return MAX (duration - nested, 0);
+}
+
+static void
+add_redraw (CtkWidget *widget,
+            gint64     time)
+{
+  CtkProfilerRedraw redraw;
+  CtkWidget *toplevel;
+  gint x, y;
+
+  /* Other toplevels keep drawing while the inspected one is idle */
+  if (redraws->len >= MAX_REDRAWS)
+    return;
+
+  toplevel = ctk_widget_get_toplevel (widget);
+  if (!ctk_widget_is_toplevel (toplevel) ||
+      !ctk_widget_translate_coordinates (widget, toplevel, 0, 0, &x, &y))
+    return;
+
+  redraw.toplevel = toplevel;
+  redraw.area.x = x;
+  redraw.area.y = y;
+  redraw.area.width = ctk_widget_get_allocated_width (widget);
+  redraw.area.height = ctk_widget_get_allocated_height (widget);
+  redraw.time = time;
+
+  g_array_append_val (redraws, redraw);
+}
+
+void
+ctk_profiler_add_widget_mark (gint64            start,
+                              CtkProfilerPhase  phase,
+                              CtkWidget        *widget)
+{
+  CtkProfilerWidgetCost *cost;
+  gint64 now, self;
+
+  now = g_get_monotonic_time ();
+
+  if (CTK_PROFILER_IS_RUNNING)
+    CDK_PRIVATE_CALL (cdk_profiler_add_mark) (start * 1000, (now - start) * 1000,
+                                              mark_names[phase],
+                                              G_OBJECT_TYPE_NAME (widget));
+
+  if (!ctk_profiler_collecting)
+    return;
+
+  self = pop_nested_spans (start, now - start);
+
+  cost = g_hash_table_lookup (widget_costs, widget);
+  if (cost == NULL || cost->type != G_OBJECT_TYPE (widget))
+    {
+      /* A new widget, or a new one at the address of a finalized one */
+      cost = g_new0 (CtkProfilerWidgetCost, 1);
+      cost->widget = widget;
+      cost->toplevel = ctk_widget_get_toplevel (widget);
+      cost->type = G_OBJECT_TYPE (widget);
+      g_hash_table_replace (widget_costs, widget, cost);
+    }
+
+  cost->time[phase] += self;
+  cost->count[phase]++;
+
+  if (phase == CTK_PROFILER_DRAW)
+    add_redraw (widget, self);
+}
+
+void
+ctk_profiler_count_style (gboolean cached)
+{
+  if (cached)
+    styles_cached++;
+  else
+    styles_computed++;
+}
+
+/* Collection is refcounted, so that the frames page and its overlay can
+ * keep it enabled independently.
+ */
+void
+ctk_profiler_start_collecting (void)
+{
+  if (collect_count++ > 0)
+    return;
+
+  spans = g_array_new (FALSE, FALSE, sizeof (Span));
+  widget_costs = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  redraws = g_array_new (FALSE, FALSE, sizeof (CtkProfilerRedraw));
+  styles_computed = 0;
+  styles_cached = 0;
+
+  ctk_profiler_collecting = TRUE;
+}
+
+void
+ctk_profiler_stop_collecting (void)
+{
+  g_return_if_fail (collect_count > 0);
+
+  if (--collect_count > 0)
+    return;
+
+  ctk_profiler_collecting = FALSE;
+
+  g_clear_pointer (&spans, g_array_unref);
+  g_clear_pointer (&widget_costs, g_hash_table_unref);
+  g_clear_pointer (&redraws, g_array_unref);
+}
+
+/* Returns the costs accumulated since the last call to
+ * ctk_profiler_reset_widget_costs(), mapping widgets to
+ * CtkProfilerWidgetCost. Only valid while collecting.
+ */
+GHashTable *
+ctk_profiler_get_widget_costs (void)
+{
+  return widget_costs;
+}
+
+void
+ctk_profiler_reset_widget_costs (void)
+{
+  if (widget_costs)
+    g_hash_table_remove_all (widget_costs);
+}
+
+/* Returns the CtkProfilerRedraw records of all widgets drawn since the
+ * last call to ctk_profiler_reset_frame(). Only valid while collecting.
+ */
+GArray *
+ctk_profiler_get_redraws (void)
+{
+  return redraws;
+}
+
+void
+ctk_profiler_get_style_counts (guint *computed,
+                               guint *cached)
+{
+  *computed = styles_computed;
+  *cached = styles_cached;
+}
+
+void
+ctk_profiler_reset_frame (void)
+{
+  if (redraws)
+    g_array_set_size (redraws, 0);
+  if (spans)
+    g_array_set_size (spans, 0);
+  styles_computed = 0;
+  styles_cached = 0;
+}
@@ -0,0 +1,124 @@
+/* CTK - The GIMP Toolkit
+ * Copyright (C) 2026 the CTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CTK_PROFILER_PRIVATE_H__
+#define __CTK_PROFILER_PRIVATE_H__
+
+#include "cdk/cdk-private.h"
+#include "ctkwidget.h"
+
+G_BEGIN_DECLS
+
+/* Marks for sysprof captures. A span starts by taking
+ * CTK_PROFILER_CURRENT_TIME, which is 0 while neither the profiler is
+ * running nor the inspector is collecting, and ends with
+ * ctk_profiler_end_mark(). The name and message are only evaluated for
+ * spans that are recorded.
+ *
+ *   gint64 before = CTK_PROFILER_CURRENT_TIME;
+ *   ...
+ *   ctk_profiler_end_mark (before, "size request", G_OBJECT_TYPE_NAME (widget));
+ */
+extern G_GNUC_INTERNAL gboolean ctk_profiler_collecting;
+
+#define CTK_PROFILER_IS_RUNNING (CDK_PRIVATE_CALL (cdk_profiler_is_running) ())
+#define CTK_PROFILER_CURRENT_TIME ((ctk_profiler_collecting || CTK_PROFILER_IS_RUNNING) ? g_get_monotonic_time () : 0)
+
+#define ctk_profiler_end_mark(start, name, message) G_STMT_START {      \
+  if ((start) != 0)                                                     \
+    ctk_profiler_add_mark ((start), (name), (message));                 \
+} G_STMT_END
+
+static inline void
+ctk_profiler_add_mark (gint64      start,
+                       const char *name,
+                       const char *message)
+{
+  if (CTK_PROFILER_IS_RUNNING)
+    CDK_PRIVATE_CALL (cdk_profiler_add_mark) (start * 1000,
+                                            (g_get_monotonic_time () - start) * 1000,
+                                            name, message);
+}
+
+/* Reports @value for the integer counter in @id, which is defined on
+ * first use. Only call this while the profiler is running.
+ */
+static inline void
+ctk_profiler_set_int_counter (guint      *id,
+                              const char *name,
+                              const char *description,
+                              gint64      value)
+{
+  if (*id == 0)
+    *id = CDK_PRIVATE_CALL (cdk_profiler_define_int_counter) (name, description);
+
+  CDK_PRIVATE_CALL (cdk_profiler_set_int_counter) (*id, g_get_monotonic_time () * 1000, value);
+}
+
+/* Per-widget costs, collected for the inspector's frames page while
+ * ctk_profiler_start_collecting() is in effect. Widget spans are ended
+ * with ctk_profiler_end_widget_mark(), which also emits a sysprof mark
+ * if the profiler is running. All times are self times in microseconds,
+ * that is, without the time spent in nested widget spans.
+ */
+typedef enum
+{
+  CTK_PROFILER_MEASURE,
+  CTK_PROFILER_ALLOCATE,
+  CTK_PROFILER_DRAW,
+  CTK_PROFILER_N_PHASES
+} CtkProfilerPhase;
+
+typedef struct
+{
+  gpointer widget;   /* only used as a key, may be dangling */
+  gpointer toplevel; /* only used for comparisons */
+  GType    type;
+  gint64   time[CTK_PROFILER_N_PHASES];
+  guint    count[CTK_PROFILER_N_PHASES];
+} CtkProfilerWidgetCost;
+
+typedef struct
+{
+  gpointer     toplevel; /* only used for comparisons */
+  CdkRectangle area;     /* in toplevel coordinates */
+  gint64       time;
+} CtkProfilerRedraw;
+
+#define ctk_profiler_end_widget_mark(start, phase, widget) G_STMT_START { \
+  if ((start) != 0)                                                       \
+    ctk_profiler_add_widget_mark ((start), (phase), (widget));            \
+} G_STMT_END
+
+void         ctk_profiler_add_widget_mark      (gint64            start,
+                                                CtkProfilerPhase  phase,
+                                                CtkWidget        *widget);
+void         ctk_profiler_count_style          (gboolean          cached);
+
+void         ctk_profiler_start_collecting     (void);
+void         ctk_profiler_stop_collecting      (void);
+
+GHashTable * ctk_profiler_get_widget_costs     (void);
+void         ctk_profiler_reset_widget_costs   (void);
+GArray *     ctk_profiler_get_redraws          (void);
+void         ctk_profiler_get_style_counts     (guint            *computed,
+                                                guint            *cached);
+void         ctk_profiler_reset_frame          (void);
+
+G_END_DECLS
+
+#endif /* __CTK_PROFILER_PRIVATE_H__ */
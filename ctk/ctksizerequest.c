@@ -26,6 +26,7 @@
 #include "ctkdebug.h"
 #include "ctkintl.h"
 #include "ctkprivate.h"
+#include "ctkprofilerprivate.h"
 #include "ctksizegroup-private.h"
 #include "ctksizerequestcacheprivate.h"
 #include "ctkwidgetprivate.h"
@@ -168,6 +169,9 @@ ctk_widget_query_size_for_orientation (CtkWidget        *widget,
   if (!found_in_cache)
     {
       gint adjusted_min, adjusted_natural, adjusted_for_size = for_size;
+      gint64 before;
+
+      before = CTK_PROFILER_CURRENT_TIME;
 
       ctk_widget_ensure_style (widget);
 
@@ -322,6 +326,8 @@ ctk_widget_query_size_for_orientation (CtkWidget        *widget,
                                       nat_size,
 				      min_baseline,
 				      nat_baseline);
+
+      ctk_profiler_end_widget_mark (before, CTK_PROFILER_MEASURE, widget);
     }
 
   if (minimum_size)
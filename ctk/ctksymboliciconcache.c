@@ -0,0 +1,340 @@
+/* CTK - The GIMP Toolkit
+ * Copyright (C) 2026 the CTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* An on-disk cache of recolored symbolic icons.
+ *
+ * Rendering a symbolic SVG means loading it, wrapping it in a stylesheet
+ * with the requested colors and rasterizing it with librsvg, which every
+ * process does again for the same handful of icons and theme colors.
+ * The results are stored here as raw pixel data under the user's cache
+ * directory, one file per (source file, size, colors) combination, and
+ * loaded back by mapping the file, so that all processes of a user share
+ * the same pages.
+ *
+ * Entries are keyed by a checksum over everything that influences the
+ * pixels, including the modification time of the source file, so stale
+ * entries are simply never looked up again. When the cache grows beyond
+ * MAX_ENTRIES files, the oldest ones are removed.
+ */
+
+#include "config.h"
+
+#include "ctksymboliciconcacheprivate.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "ctkdebug.h"
+
+#define CACHE_MAGIC "CTKSYMIC"
+#define CACHE_VERSION 1
+
+#define MAX_ENTRIES 2048
+
+/* Larger entries can only come from a corrupt file */
+#define MAX_ICON_SIZE 4096
+
+typedef struct
+{
+  gchar   magic[8];
+  guint32 version;
+  guint32 width;
+  guint32 height;
+  guint32 rowstride;
+} CacheHeader;
+
+static gboolean
+cache_enabled (void)
+{
+  static gsize enabled = 0;
+
+  if (g_once_init_enter (&enabled))
+    {
+      gboolean value;
+
+      value = g_strcmp0 (g_getenv ("CTK_SYMBOLIC_ICON_CACHE"), "0") != 0;
+      g_once_init_leave (&enabled, value ? 2 : 1);
+    }
+
+  return enabled == 2;
+}
+
+static const gchar *
+get_cache_dir (void)
+{
+  static gchar *cache_dir = NULL;
+
+  if (g_once_init_enter (&cache_dir))
+    {
+      gchar *dir;
+
+      dir = g_build_filename (g_get_user_cache_dir (), "ctk-3.0", "symbolic-icons", NULL);
+      g_once_init_leave (&cache_dir, dir);
+    }
+
+  return cache_dir;
+}
+
+static void
+append_color (GString       *str,
+              const CdkRGBA *color)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+  gdouble components[4];
+  int i;
+
+  if (color == NULL)
+    {
+      g_string_append (str, "|-");
+      return;
+    }
+
+  /* Independent of the locale, so all processes agree on the key */
+  components[0] = color->red;
+  components[1] = color->green;
+  components[2] = color->blue;
+  components[3] = color->alpha;
+
+  for (i = 0; i < 4; i++)
+    {
+      g_string_append_c (str, i == 0 ? '|' : ',');
+      g_string_append (str, g_ascii_formatd (buf, sizeof (buf), "%.4f", components[i]));
+    }
+}
+
+static gchar *
+get_cache_path (const CtkSymbolicIconKey *key)
+{
+  GStatBuf st;
+  GString *str;
+  gchar *checksum;
+  gchar *path;
+
+  if (!cache_enabled () || key->filename == NULL)
+    return NULL;
+
+  if (g_stat (key->filename, &st) != 0)
+    return NULL;
+
+  str = g_string_new (key->filename);
+  g_string_append_printf (str, "|%" G_GINT64_FORMAT "|%" G_GINT64_FORMAT,
+                          (gint64) st.st_mtime, (gint64) st.st_size);
+  g_string_append_printf (str, "|%d|%d|%d|%d|%d|%d|%d|%d",
+                          key->dir_type, key->dir_size, key->dir_scale,
+                          key->min_size, key->max_size,
+                          key->desired_size, key->desired_scale,
+                          key->forced_size ? 1 : 0);
+  append_color (str, key->fg);
+  append_color (str, key->success_color);
+  append_color (str, key->warning_color);
+  append_color (str, key->error_color);
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, str->str, str->len);
+  path = g_build_filename (get_cache_dir (), checksum, NULL);
+
+  g_free (checksum);
+  g_string_free (str, TRUE);
+
+  return path;
+}
+
+static void
+unmap_pixels (guchar   *pixels,
+              gpointer  data)
+{
+  g_mapped_file_unref (data);
+}
+
+GdkPixbuf *
+ctk_symbolic_icon_cache_lookup (const CtkSymbolicIconKey *key)
+{
+  GMappedFile *map;
+  const CacheHeader *header;
+  const gchar *contents;
+  gsize length;
+  gchar *path;
+
+  path = get_cache_path (key);
+  if (path == NULL)
+    return NULL;
+
+  /* Map privately writable, so that a consumer that pokes at the
+   * pixels gets its own copy instead of crashing.
+   */
+  map = g_mapped_file_new (path, TRUE, NULL);
+  g_free (path);
+
+  if (map == NULL)
+    return NULL;
+
+  contents = g_mapped_file_get_contents (map);
+  length = g_mapped_file_get_length (map);
+  header = (const CacheHeader *) contents;
+
+  if (length < sizeof (CacheHeader) ||
+      memcmp (header->magic, CACHE_MAGIC, sizeof (header->magic)) != 0 ||
+      header->version != CACHE_VERSION ||
+      header->width == 0 || header->width > MAX_ICON_SIZE ||
+      header->height == 0 || header->height > MAX_ICON_SIZE ||
+      header->rowstride > G_MAXINT ||
+      header->rowstride < (guint64) header->width * 4 ||
+      (guint64) length - sizeof (CacheHeader) < (guint64) header->rowstride * header->height)
+    {
+      g_mapped_file_unref (map);
+      return NULL;
+    }
+
+  CTK_NOTE (ICONTHEME,
+            g_message ("symbolic icon cache hit for %s at %d@%d",
+                       key->filename, key->desired_size, key->desired_scale));
+
+  return gdk_pixbuf_new_from_data ((guchar *) contents + sizeof (CacheHeader),
+                                   GDK_COLORSPACE_RGB, TRUE, 8,
+                                   header->width, header->height,
+                                   header->rowstride,
+                                   unmap_pixels, map);
+}
+
+typedef struct
+{
+  gchar *path;
+  gint64 mtime;
+} CacheEntry;
+
+static gint
+compare_entries (gconstpointer a,
+                 gconstpointer b)
+{
+  const CacheEntry *entry_a = a;
+  const CacheEntry *entry_b = b;
+
+  return (entry_a->mtime > entry_b->mtime) - (entry_a->mtime < entry_b->mtime);
+}
+
+/* Removes the oldest entries if the cache holds more than MAX_ENTRIES
+ * files, bringing it down to three quarters of that.
+ */
+static void
+expire_entries (const gchar *cache_dir)
+{
+  GArray *entries;
+  const gchar *name;
+  GDir *dir;
+  guint i;
+
+  dir = g_dir_open (cache_dir, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  entries = g_array_new (FALSE, FALSE, sizeof (CacheEntry));
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      CacheEntry entry;
+      GStatBuf st;
+
+      entry.path = g_build_filename (cache_dir, name, NULL);
+      if (g_stat (entry.path, &st) != 0)
+        {
+          g_free (entry.path);
+          continue;
+        }
+
+      entry.mtime = st.st_mtime;
+      g_array_append_val (entries, entry);
+    }
+
+  g_dir_close (dir);
+
+  if (entries->len > MAX_ENTRIES)
+    {
+      g_array_sort (entries, compare_entries);
+
+      for (i = 0; i < entries->len - MAX_ENTRIES * 3 / 4; i++)
+        g_unlink (g_array_index (entries, CacheEntry, i).path);
+    }
+
+  for (i = 0; i < entries->len; i++)
+    g_free (g_array_index (entries, CacheEntry, i).path);
+  g_array_free (entries, TRUE);
+}
+
+void
+ctk_symbolic_icon_cache_store (const CtkSymbolicIconKey *key,
+                               GdkPixbuf                *pixbuf)
+{
+  static gsize expired = 0;
+  CacheHeader header;
+  const guchar *pixels;
+  gchar *contents;
+  gsize length;
+  gint width, height, rowstride;
+  gchar *path;
+
+  if (gdk_pixbuf_get_colorspace (pixbuf) != GDK_COLORSPACE_RGB ||
+      gdk_pixbuf_get_bits_per_sample (pixbuf) != 8 ||
+      gdk_pixbuf_get_n_channels (pixbuf) != 4 ||
+      !gdk_pixbuf_get_has_alpha (pixbuf) ||
+      gdk_pixbuf_get_width (pixbuf) > MAX_ICON_SIZE ||
+      gdk_pixbuf_get_height (pixbuf) > MAX_ICON_SIZE)
+    return;
+
+  path = get_cache_path (key);
+  if (path == NULL)
+    return;
+
+  if (g_mkdir_with_parents (get_cache_dir (), 0700) != 0)
+    {
+      g_free (path);
+      return;
+    }
+
+  /* Check the size of the cache once per process */
+  if (g_once_init_enter (&expired))
+    {
+      expire_entries (get_cache_dir ());
+      g_once_init_leave (&expired, 1);
+    }
+
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+  pixels = gdk_pixbuf_get_pixels (pixbuf);
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, CACHE_MAGIC, sizeof (header.magic));
+  header.version = CACHE_VERSION;
+  header.width = width;
+  header.height = height;
+  header.rowstride = rowstride;
+
+  length = sizeof (header) + (gsize) rowstride * height;
+  contents = g_malloc (length);
+  memcpy (contents, &header, sizeof (header));
+  /* The last row of a pixbuf is not necessarily padded to rowstride */
+  memcpy (contents + sizeof (header), pixels, (gsize) rowstride * (height - 1) + width * 4);
+  memset (contents + sizeof (header) + (gsize) rowstride * (height - 1) + width * 4,
+          0, rowstride - width * 4);
+
+  /* g_file_set_contents() writes to a temporary file and renames it,
+   * so concurrent readers never see a partial entry.
+   */
+  g_file_set_contents (path, contents, length, NULL);
+
+  g_free (contents);
+  g_free (path);
+}
@@ -0,0 +1,50 @@
+/* CTK - The GIMP Toolkit
+ * Copyright (C) 2026 the CTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CTK_SYMBOLIC_ICON_CACHE_PRIVATE_H__
+#define __CTK_SYMBOLIC_ICON_CACHE_PRIVATE_H__
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <cdk/cdk.h>
+
+G_BEGIN_DECLS
+
+/* Everything that determines the pixels of a recolored symbolic icon */
+typedef struct
+{
+  const gchar   *filename;
+  gint           dir_type;
+  gint           dir_size;
+  gint           dir_scale;
+  gint           min_size;
+  gint           max_size;
+  gint           desired_size;
+  gint           desired_scale;
+  gboolean       forced_size;
+  const CdkRGBA *fg;
+  const CdkRGBA *success_color;
+  const CdkRGBA *warning_color;
+  const CdkRGBA *error_color;
+} CtkSymbolicIconKey;
+
+GdkPixbuf *     ctk_symbolic_icon_cache_lookup  (const CtkSymbolicIconKey *key);
+void            ctk_symbolic_icon_cache_store   (const CtkSymbolicIconKey *key,
+                                                 GdkPixbuf                *pixbuf);
+
+G_END_DECLS
+
+#endif /* __CTK_SYMBOLIC_ICON_CACHE_PRIVATE_H__ */
@@ -2325,25 +2325,29 @@ _ctk_text_btree_get_tags (const CtkTextIter *iter,
   return tagInfo.tags;
 }
 
-static void
-copy_segment (GString *string,
-              gboolean include_hidden,
-              gboolean include_nonchars,
-              const CtkTextIter *start,
-              const CtkTextIter *end)
+/* Returns the portion of the indexable segment at @start that lies
+ * before @end, pointing straight into the segment's storage. Returns
+ * %FALSE if there is nothing to copy from this segment.
+ */
+static gboolean
+get_segment_chunk (gboolean            include_hidden,
+                   gboolean            include_nonchars,
+                   const CtkTextIter  *start,
+                   const CtkTextIter  *end,
+                   const gchar       **text,
+                   gsize              *len)
 {
   CtkTextLineSegment *end_seg;
   CtkTextLineSegment *seg;
 
   if (ctk_text_iter_equal (start, end))
-    return;
+    return FALSE;
 
   seg = _ctk_text_iter_get_indexable_segment (start);
   end_seg = _ctk_text_iter_get_indexable_segment (end);
 
   if (seg->type == &ctk_text_char_type)
     {
-      gboolean copy = TRUE;
       gint copy_bytes = 0;
       gint copy_start = 0;
 
@@ -2351,10 +2355,7 @@ copy_segment (GString *string,
          as a whole, no need to check each char */
       if (!include_hidden &&
           _ctk_text_btree_char_is_invisible (start))
-        {
-          copy = FALSE;
-          /* printf (" <invisible>\n"); */
-        }
+        return FALSE;
 
       copy_start = _ctk_text_iter_get_segment_byte (start);
 
@@ -2370,87 +2371,112 @@ copy_segment (GString *string,
 
       g_assert (copy_bytes != 0); /* Due to iter equality check at
                                      front of this function. */
+      g_assert ((copy_start + copy_bytes) <= seg->byte_count);
 
-      if (copy)
-        {
-          g_assert ((copy_start + copy_bytes) <= seg->byte_count);
+      *text = seg->body.chars + copy_start;
+      *len = copy_bytes;
 
-          g_string_append_len (string,
-                               seg->body.chars + copy_start,
-                               copy_bytes);
-        }
-
-      /* printf ("  :%s\n", string->str); */
+      return TRUE;
     }
   else if (seg->type == &ctk_text_pixbuf_type ||
            seg->type == &ctk_text_child_type)
     {
-      gboolean copy = TRUE;
-
       if (!include_nonchars)
-        {
-          copy = FALSE;
-        }
-      else if (!include_hidden &&
-               _ctk_text_btree_char_is_invisible (start))
-        {
-          copy = FALSE;
-        }
+        return FALSE;
 
-      if (copy)
-        {
-          g_string_append_len (string,
-                               _ctk_text_unknown_char_utf8,
-                               CTK_TEXT_UNKNOWN_CHAR_UTF8_LEN);
+      if (!include_hidden &&
+          _ctk_text_btree_char_is_invisible (start))
+        return FALSE;
 
-        }
+      *text = _ctk_text_unknown_char_utf8;
+      *len = CTK_TEXT_UNKNOWN_CHAR_UTF8_LEN;
+
+      return TRUE;
     }
+
+  return FALSE;
 }
 
-gchar*
-_ctk_text_btree_get_text (const CtkTextIter *start_orig,
-                         const CtkTextIter *end_orig,
-                         gboolean include_hidden,
-                         gboolean include_nonchars)
+gboolean
+_ctk_text_btree_foreach_chunk (const CtkTextIter      *start_orig,
+                               const CtkTextIter      *end_orig,
+                               gboolean                include_hidden,
+                               gboolean                include_nonchars,
+                               CtkTextBufferChunkFunc  func,
+                               gpointer                user_data)
 {
   CtkTextLineSegment *seg;
   CtkTextLineSegment *end_seg;
-  GString *retval;
-  gchar *str;
   CtkTextIter iter;
   CtkTextIter start;
   CtkTextIter end;
+  const gchar *text;
+  gsize len;
 
-  g_return_val_if_fail (start_orig != NULL, NULL);
-  g_return_val_if_fail (end_orig != NULL, NULL);
+  g_return_val_if_fail (start_orig != NULL, FALSE);
+  g_return_val_if_fail (end_orig != NULL, FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
   g_return_val_if_fail (_ctk_text_iter_get_btree (start_orig) ==
-                        _ctk_text_iter_get_btree (end_orig), NULL);
+                        _ctk_text_iter_get_btree (end_orig), FALSE);
 
   start = *start_orig;
   end = *end_orig;
 
   ctk_text_iter_order (&start, &end);
 
-  retval = g_string_new (NULL);
-
   end_seg = _ctk_text_iter_get_indexable_segment (&end);
   iter = start;
   seg = _ctk_text_iter_get_indexable_segment (&iter);
   while (seg != end_seg)
     {
-      copy_segment (retval, include_hidden, include_nonchars,
-                    &iter, &end);
+      if (get_segment_chunk (include_hidden, include_nonchars,
+                             &iter, &end, &text, &len) &&
+          !func (text, len, user_data))
+        return FALSE;
 
       _ctk_text_iter_forward_indexable_segment (&iter);
 
       seg = _ctk_text_iter_get_indexable_segment (&iter);
     }
 
-  copy_segment (retval, include_hidden, include_nonchars, &iter, &end);
+  if (get_segment_chunk (include_hidden, include_nonchars,
+                         &iter, &end, &text, &len) &&
+      !func (text, len, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+append_chunk (const gchar *text,
+              gsize        len,
+              gpointer     user_data)
+{
+  g_string_append_len (user_data, text, len);
+
+  return TRUE;
+}
+
+gchar *
+_ctk_text_btree_get_text (const CtkTextIter *start_orig,
+                         const CtkTextIter *end_orig,
+                         gboolean include_hidden,
+                         gboolean include_nonchars)
+{
+  GString *retval;
+
+  g_return_val_if_fail (start_orig != NULL, NULL);
+  g_return_val_if_fail (end_orig != NULL, NULL);
+  g_return_val_if_fail (_ctk_text_iter_get_btree (start_orig) ==
+                        _ctk_text_iter_get_btree (end_orig), NULL);
+
+  retval = g_string_new (NULL);
+
+  _ctk_text_btree_foreach_chunk (start_orig, end_orig,
+                                 include_hidden, include_nonchars,
+                                 append_chunk, retval);
 
-  str = retval->str;
-  g_string_free (retval, FALSE);
-  return str;
+  return g_string_free (retval, FALSE);
 }
 
 gint
@@ -134,6 +134,12 @@ gchar        *_ctk_text_btree_get_text          (const CtkTextIter *start,
                                                  const CtkTextIter *end,
                                                  gboolean           include_hidden,
                                                  gboolean           include_nonchars);
+gboolean      _ctk_text_btree_foreach_chunk     (const CtkTextIter      *start,
+                                                 const CtkTextIter      *end,
+                                                 gboolean                include_hidden,
+                                                 gboolean                include_nonchars,
+                                                 CtkTextBufferChunkFunc  func,
+                                                 gpointer                user_data);
 gint          _ctk_text_btree_line_count        (CtkTextBTree      *tree);
 gint          _ctk_text_btree_char_count        (CtkTextBTree      *tree);
 gboolean      _ctk_text_btree_char_is_invisible (const CtkTextIter *iter);
@@ -1907,6 +1907,128 @@ ctk_text_buffer_get_slice (CtkTextBuffer     *buffer,
     return ctk_text_iter_get_visible_slice (start, end);
 }
 
+/**
+ * ctk_text_buffer_foreach_chunk:
+ * @buffer: a #CtkTextBuffer
+ * @start: start of a range
+ * @end: end of a range
+ * @include_hidden_chars: whether to include invisible text
+ * @func: (scope call): function to call for each chunk of text
+ * @user_data: data to pass to @func
+ *
+ * Calls @func for each contiguous run of text in the range
+ * [@start,@end), in order, without copying or concatenating it.
+ * The text passed to @func is the same that ctk_text_buffer_get_text()
+ * would return for the range, split at the buffer’s internal segment
+ * boundaries.
+ *
+ * This is useful for writing out or searching large buffers without
+ * allocating a copy of their contents. The buffer must not be modified
+ * from within @func.
+ *
+ * Returns: %TRUE if all chunks were visited, %FALSE if @func
+ *   stopped the iteration
+ *
+ * Since: 3.25.5
+ **/
+gboolean
+ctk_text_buffer_foreach_chunk (CtkTextBuffer          *buffer,
+                               const CtkTextIter      *start,
+                               const CtkTextIter      *end,
+                               gboolean                include_hidden_chars,
+                               CtkTextBufferChunkFunc  func,
+                               gpointer                user_data)
+{
+  g_return_val_if_fail (CTK_IS_TEXT_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (start != NULL, FALSE);
+  g_return_val_if_fail (end != NULL, FALSE);
+  g_return_val_if_fail (ctk_text_iter_get_buffer (start) == buffer, FALSE);
+  g_return_val_if_fail (ctk_text_iter_get_buffer (end) == buffer, FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  return _ctk_text_btree_foreach_chunk (start, end,
+                                        include_hidden_chars, FALSE,
+                                        func, user_data);
+}
+
+static gboolean
+count_chunk (const gchar *text,
+             gsize        len,
+             gpointer     user_data)
+{
+  gsize *size = user_data;
+
+  *size += len;
+
+  return TRUE;
+}
+
+static gboolean
+copy_chunk (const gchar *text,
+            gsize        len,
+            gpointer     user_data)
+{
+  gchar **dest = user_data;
+
+  memcpy (*dest, text, len);
+  *dest += len;
+
+  return TRUE;
+}
+
+/**
+ * ctk_text_buffer_get_bytes:
+ * @buffer: a #CtkTextBuffer
+ * @start: start of a range
+ * @end: end of a range
+ * @include_hidden_chars: whether to include invisible text
+ *
+ * Returns the same text as ctk_text_buffer_get_text(), as an
+ * immutable snapshot. The contents are copied once into an allocation
+ * of exactly the required size, rather than into a growing string, so
+ * that copying a large buffer does not transiently need more than the
+ * size of the text.
+ *
+ * The returned #GBytes is not tied to @buffer and may be handed to
+ * another thread, for example to write it out with
+ * g_output_stream_write_bytes_async(), or read through
+ * g_memory_input_stream_new_from_bytes().
+ *
+ * Returns: (transfer full): a #GBytes with the UTF-8 text, not
+ *   nul-terminated
+ *
+ * Since: 3.25.5
+ **/
+GBytes *
+ctk_text_buffer_get_bytes (CtkTextBuffer     *buffer,
+                           const CtkTextIter *start,
+                           const CtkTextIter *end,
+                           gboolean           include_hidden_chars)
+{
+  gsize size = 0;
+  gchar *data;
+  gchar *p;
+
+  g_return_val_if_fail (CTK_IS_TEXT_BUFFER (buffer), NULL);
+  g_return_val_if_fail (start != NULL, NULL);
+  g_return_val_if_fail (end != NULL, NULL);
+  g_return_val_if_fail (ctk_text_iter_get_buffer (start) == buffer, NULL);
+  g_return_val_if_fail (ctk_text_iter_get_buffer (end) == buffer, NULL);
+
+  _ctk_text_btree_foreach_chunk (start, end, include_hidden_chars, FALSE,
+                                 count_chunk, &size);
+
+  if (size == 0)
+    return g_bytes_new (NULL, 0);
+
+  data = p = g_malloc (size);
+  _ctk_text_btree_foreach_chunk (start, end, include_hidden_chars, FALSE,
+                                 copy_chunk, &p);
+  g_assert (p == data + size);
+
+  return g_bytes_new_take (data, size);
+}
+
 /*
  * Pixbufs
  */
@@ -65,6 +65,25 @@ typedef enum
 
 typedef struct _CtkTextBTree CtkTextBTree;
 
+/**
+ * CtkTextBufferChunkFunc:
+ * @text: (array length=len) (element-type guint8): a run of UTF-8 text
+ *   owned by the buffer
+ * @len: the length of @text in bytes
+ * @user_data: data passed to ctk_text_buffer_foreach_chunk()
+ *
+ * A function used with ctk_text_buffer_foreach_chunk(). @text points
+ * directly into the buffer’s storage; it is not nul-terminated and is
+ * only valid for the duration of the call.
+ *
+ * Returns: %TRUE to continue with the next chunk, %FALSE to stop
+ *
+ * Since: 3.25.5
+ */
+typedef gboolean (* CtkTextBufferChunkFunc) (const gchar *text,
+                                             gsize        len,
+                                             gpointer     user_data);
+
 #define CTK_TYPE_TEXT_BUFFER            (ctk_text_buffer_get_type ())
 #define CTK_TEXT_BUFFER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CTK_TYPE_TEXT_BUFFER, CtkTextBuffer))
 #define CTK_TEXT_BUFFER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), CTK_TYPE_TEXT_BUFFER, CtkTextBufferClass))
@@ -271,6 +290,19 @@ gchar          *ctk_text_buffer_get_slice           (CtkTextBuffer     *buffer,
                                                      const CtkTextIter *end,
                                                      gboolean           include_hidden_chars);
 
+CDK_AVAILABLE_IN_ALL
+gboolean        ctk_text_buffer_foreach_chunk       (CtkTextBuffer          *buffer,
+                                                     const CtkTextIter      *start,
+                                                     const CtkTextIter      *end,
+                                                     gboolean                include_hidden_chars,
+                                                     CtkTextBufferChunkFunc  func,
+                                                     gpointer                user_data);
+CDK_AVAILABLE_IN_ALL
+GBytes         *ctk_text_buffer_get_bytes           (CtkTextBuffer          *buffer,
+                                                     const CtkTextIter      *start,
+                                                     const CtkTextIter      *end,
+                                                     gboolean                include_hidden_chars);
+
 /* Insert a pixbuf */
 CDK_AVAILABLE_IN_ALL
 void ctk_text_buffer_insert_pixbuf         (CtkTextBuffer *buffer,
@@ -30,14 +30,14 @@
 
 #include "gdk-pixbuf/gdk-pixdata.h"
 #include "ctktextbufferserialize.h"
+#include "ctktextbtree.h"
 #include "ctktexttagprivate.h"
 #include "ctkintl.h"
 
 
 typedef struct
 {
-  GString *tag_table_str;
-  GString *text_str;
+  GString *str;
   GHashTable *tags;
   CtkTextIter start, end;
 
@@ -292,23 +292,23 @@ serialize_tag (gpointer key,
   guint n_pspecs;
   int i;
 
-  g_string_append (context->tag_table_str, "  <tag ");
+  g_string_append (context->str, "  <tag ");
 
   /* Handle anonymous tags */
   if (tag->priv->name)
     {
       tag_name = g_markup_escape_text (tag->priv->name, -1);
-      g_string_append_printf (context->tag_table_str, "name=\"%s\"", tag_name);
+      g_string_append_printf (context->str, "name=\"%s\"", tag_name);
       g_free (tag_name);
     }
   else
     {
       tag_id = GPOINTER_TO_INT (g_hash_table_lookup (context->tag_id_tags, tag));
 
-      g_string_append_printf (context->tag_table_str, "id=\"%d\"", tag_id);
+      g_string_append_printf (context->str, "id=\"%d\"", tag_id);
     }
 
-  g_string_append_printf (context->tag_table_str, " priority=\"%d\">\n", tag->priv->priority);
+  g_string_append_printf (context->str, " priority=\"%d\">\n", tag->priv->priority);
 
   /* Serialize properties */
   pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (tag), &n_pspecs);
@@ -331,11 +331,11 @@ serialize_tag (gpointer key,
       if (tmp2)
 	{
 	  tmp = g_markup_escape_text (pspecs[i]->name, -1);
-	  g_string_append_printf (context->tag_table_str, "   <attr name=\"%s\" ", tmp);
+	  g_string_append_printf (context->str, "   <attr name=\"%s\" ", tmp);
 	  g_free (tmp);
 
 	  tmp = g_markup_escape_text (g_type_name (pspecs[i]->value_type), -1);
-	  g_string_append_printf (context->tag_table_str, "type=\"%s\" value=\"%s\" />\n", tmp, tmp2);
+	  g_string_append_printf (context->str, "type=\"%s\" value=\"%s\" />\n", tmp, tmp2);
 
 	  g_free (tmp);
 	  g_free (tmp2);
@@ -346,16 +346,54 @@ serialize_tag (gpointer key,
 
   g_free (pspecs);
 
-  g_string_append (context->tag_table_str, "  </tag>\n");
+  g_string_append (context->str, "  </tag>\n");
 }
 
 static void
 serialize_tags (SerializationContext *context)
 {
-  g_string_append (context->tag_table_str, " <text_view_markup>\n");
-  g_string_append (context->tag_table_str, " <tags>\n");
+  g_string_append (context->str, " <text_view_markup>\n");
+  g_string_append (context->str, " <tags>\n");
   g_hash_table_foreach (context->tags, serialize_tag, context);
-  g_string_append (context->tag_table_str, " </tags>\n");
+  g_string_append (context->str, " </tags>\n");
+}
+
+static void
+add_tag (SerializationContext *context,
+         CtkTextTag           *tag)
+{
+  g_hash_table_insert (context->tags, tag, tag);
+
+  /* Anonymous tags are referred to by an id */
+  if (tag->priv->name == NULL &&
+      !g_hash_table_contains (context->tag_id_tags, tag))
+    g_hash_table_insert (context->tag_id_tags, tag, GINT_TO_POINTER (context->tag_id++));
+}
+
+/* Finds the tags used between start and end, so that the tag table
+ * can be written before the text.
+ */
+static void
+collect_tags (SerializationContext *context)
+{
+  CtkTextIter iter;
+  GSList *tags, *l;
+
+  iter = context->start;
+  tags = ctk_text_iter_get_tags (&iter);
+
+  while (TRUE)
+    {
+      for (l = tags; l; l = l->next)
+        add_tag (context, l->data);
+      g_slist_free (tags);
+
+      if (!ctk_text_iter_forward_to_tag_toggle (&iter, NULL) ||
+          ctk_text_iter_compare (&iter, &context->end) >= 0)
+        break;
+
+      tags = ctk_text_iter_get_toggled_tags (&iter, TRUE);
+    }
 }
 
 static void
@@ -412,6 +450,32 @@ serialize_section_header (GString     *str,
   g_string_append_c (str, length & 0xff);
 }
 
+static gboolean
+append_escaped_chunk (const gchar *text,
+                      gsize        len,
+                      gpointer     user_data)
+{
+  gchar *escaped_text;
+
+  escaped_text = g_markup_escape_text (text, len);
+  g_string_append (user_data, escaped_text);
+  g_free (escaped_text);
+
+  return TRUE;
+}
+
+/* Appends the escaped slice between @start and @end, one btree
+ * segment at a time, so that long runs are never copied out whole.
+ */
+static void
+serialize_slice (SerializationContext *context,
+                 const CtkTextIter    *start,
+                 const CtkTextIter    *end)
+{
+  _ctk_text_btree_foreach_chunk (start, end, TRUE, TRUE,
+                                 append_escaped_chunk, context->str);
+}
+
 static void
 serialize_text (CtkTextBuffer        *buffer,
                 SerializationContext *context)
@@ -420,7 +484,7 @@ serialize_text (CtkTextBuffer        *buffer,
   GSList *tag_list, *new_tag_list;
   GSList *active_tags;
 
-  g_string_append (context->text_str, "<text>");
+  g_string_append (context->str, "<text>");
 
   iter = context->start;
   tag_list = NULL;
@@ -430,7 +494,6 @@ serialize_text (CtkTextBuffer        *buffer,
     {
       GList *added, *removed;
       GList *tmp;
-      gchar *tmp_text, *escaped_text;
 
       new_tag_list = ctk_text_iter_get_tags (&iter);
       find_list_delta (tag_list, new_tag_list, &added, &removed);
@@ -445,7 +508,7 @@ serialize_text (CtkTextBuffer        *buffer,
            */
           if (g_slist_find (active_tags, tag))
             {
-              g_string_append (context->text_str, "</apply_tag>");
+              g_string_append (context->str, "</apply_tag>");
 
               /* Drop all tags that were opened after this one (which are
                * above this on in the stack)
@@ -454,7 +517,7 @@ serialize_text (CtkTextBuffer        *buffer,
                 {
                   added = g_list_prepend (added, active_tags->data);
                   active_tags = g_slist_remove (active_tags, active_tags->data);
-                  g_string_append_printf (context->text_str, "</apply_tag>");
+                  g_string_append_printf (context->str, "</apply_tag>");
                 }
 
               active_tags = g_slist_remove (active_tags, active_tags->data);
@@ -467,30 +530,21 @@ serialize_text (CtkTextBuffer        *buffer,
 	  CtkTextTag *tag = tmp->data;
 	  gchar *tag_name;
 
-	  /* Add it to the tag hash table */
-	  g_hash_table_insert (context->tags, tag, tag);
-
 	  if (tag->priv->name)
 	    {
 	      tag_name = g_markup_escape_text (tag->priv->name, -1);
 
-	      g_string_append_printf (context->text_str, "<apply_tag name=\"%s\">", tag_name);
+	      g_string_append_printf (context->str, "<apply_tag name=\"%s\">", tag_name);
 	      g_free (tag_name);
 	    }
 	  else
 	    {
-	      gpointer tag_id;
+	      gint tag_id;
 
-	      /* We've got an anonymous tag, find out if it's been
-		 used before */
-	      if (!g_hash_table_lookup_extended (context->tag_id_tags, tag, NULL, &tag_id))
-		{
-		  tag_id = GINT_TO_POINTER (context->tag_id++);
-
-		  g_hash_table_insert (context->tag_id_tags, tag, tag_id);
-		}
+	      /* Anonymous tags got their id in collect_tags() */
+	      tag_id = GPOINTER_TO_INT (g_hash_table_lookup (context->tag_id_tags, tag));
 
-	      g_string_append_printf (context->text_str, "<apply_tag id=\"%d\">", GPOINTER_TO_INT (tag_id));
+	      g_string_append_printf (context->str, "<apply_tag id=\"%d\">", tag_id);
 	    }
 
 	  active_tags = g_slist_prepend (active_tags, tag);
@@ -516,18 +570,13 @@ serialize_text (CtkTextBuffer        *buffer,
 	      if (pixbuf)
 		{
 		  /* Append the text before the pixbuf */
-		  tmp_text = ctk_text_iter_get_slice (&old_iter, &iter);
-		  escaped_text = g_markup_escape_text (tmp_text, -1);
-		  g_free (tmp_text);
+		  serialize_slice (context, &old_iter, &iter);
 
 		  /* Forward so we don't get the 0xfffc char */
 		  ctk_text_iter_forward_char (&iter);
 		  old_iter = iter;
 
-		  g_string_append (context->text_str, escaped_text);
-		  g_free (escaped_text);
-
-		  g_string_append_printf (context->text_str, "<pixbuf index=\"%d\" />", context->n_pixbufs);
+		  g_string_append_printf (context->str, "<pixbuf index=\"%d\" />", context->n_pixbufs);
 
 		  context->n_pixbufs++;
 		  context->pixbufs = g_list_prepend (context->pixbufs, pixbuf);
@@ -549,12 +598,7 @@ serialize_text (CtkTextBuffer        *buffer,
 	iter = context->end;
 
       /* Append the text */
-      tmp_text = ctk_text_iter_get_slice (&old_iter, &iter);
-      escaped_text = g_markup_escape_text (tmp_text, -1);
-      g_free (tmp_text);
-
-      g_string_append (context->text_str, escaped_text);
-      g_free (escaped_text);
+      serialize_slice (context, &old_iter, &iter);
     }
   while (!ctk_text_iter_equal (&iter, &context->end));
 
@@ -562,10 +606,10 @@ serialize_text (CtkTextBuffer        *buffer,
 
   /* Close any open tags */
   for (tag_list = active_tags; tag_list; tag_list = tag_list->next)
-    g_string_append (context->text_str, "</apply_tag>");
+    g_string_append (context->str, "</apply_tag>");
 
   g_slist_free (active_tags);
-  g_string_append (context->text_str, "</text>\n</text_view_markup>\n");
+  g_string_append (context->str, "</text>\n</text_view_markup>\n");
 }
 
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
@@ -601,11 +645,11 @@ _ctk_text_buffer_serialize_rich_text (CtkTextBuffer     *register_buffer,
                                       gpointer           user_data)
 {
   SerializationContext context;
-  GString *text;
+  gsize contents_start;
+  gsize contents_length;
 
   context.tags = g_hash_table_new (NULL, NULL);
-  context.text_str = g_string_new (NULL);
-  context.tag_table_str = g_string_new (NULL);
+  context.str = g_string_new (NULL);
   context.start = *start;
   context.end = *end;
   context.n_pixbufs = 0;
@@ -613,30 +657,35 @@ _ctk_text_buffer_serialize_rich_text (CtkTextBuffer     *register_buffer,
   context.tag_id = 0;
   context.tag_id_tags = g_hash_table_new (NULL, NULL);
 
-  /* We need to serialize the text before the tag table so we know
-     what tags are used */
-  serialize_text (content_buffer, &context);
-  serialize_tags (&context);
+  /* Everything is written in order into a single string, so only one
+   * document-sized buffer is live at a time. The tags are found in a
+   * first pass so the tag table can go before the text, and the
+   * section length is filled in once the text is done.
+   */
+  collect_tags (&context);
+
+  serialize_section_header (context.str, "CTKTEXTBUFFERCONTENTS-0001", 0);
+  contents_start = context.str->len;
 
-  text = g_string_new (NULL);
-  serialize_section_header (text, "CTKTEXTBUFFERCONTENTS-0001",
-                            context.tag_table_str->len + context.text_str->len);
+  serialize_tags (&context);
+  serialize_text (content_buffer, &context);
 
-  g_string_append_len (text, context.tag_table_str->str, context.tag_table_str->len);
-  g_string_append_len (text, context.text_str->str, context.text_str->len);
+  contents_length = context.str->len - contents_start;
+  context.str->str[contents_start - 4] = contents_length >> 24;
+  context.str->str[contents_start - 3] = (contents_length >> 16) & 0xff;
+  context.str->str[contents_start - 2] = (contents_length >> 8) & 0xff;
+  context.str->str[contents_start - 1] = contents_length & 0xff;
 
   context.pixbufs = g_list_reverse (context.pixbufs);
-  serialize_pixbufs (&context, text);
+  serialize_pixbufs (&context, context.str);
 
   g_hash_table_destroy (context.tags);
   g_list_free (context.pixbufs);
-  g_string_free (context.text_str, TRUE);
-  g_string_free (context.tag_table_str, TRUE);
   g_hash_table_destroy (context.tag_id_tags);
 
-  *length = text->len;
+  *length = context.str->len;
 
-  return (guint8 *) g_string_free (text, FALSE);
+  return (guint8 *) g_string_free (context.str, FALSE);
 }
 
 typedef enum
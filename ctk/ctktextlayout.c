@@ -99,8 +99,19 @@ struct _CtkTextLayoutPrivate
      direction only influences the direction of the cursor line.
   */
   CtkTextLine *cursor_line;
+
+  /* Merged attributes for each combination of active tags seen
+   * since the last time the style cache was freed; see get_style().
+   */
+  GHashTable *style_cache;
 };
 
+typedef struct
+{
+  guint        n_tags;
+  CtkTextTag **tags;
+} StyleCacheKey;
+
 static CtkTextLineData *ctk_text_layout_real_wrap (CtkTextLayout *layout,
                                                    CtkTextLine *line,
                                                    /* may be NULL */
@@ -219,6 +230,8 @@ ctk_text_layout_finalize (GObject *object)
   layout = CTK_TEXT_LAYOUT (object);
 
   g_free (layout->preedit_string);
+  g_clear_pointer (&CTK_TEXT_LAYOUT_GET_PRIVATE (layout)->style_cache,
+                   g_hash_table_unref);
 
   G_OBJECT_CLASS (ctk_text_layout_parent_class)->finalize (object);
 }
@@ -287,8 +300,42 @@ ctk_text_layout_new (void)
   return g_object_new (CTK_TYPE_TEXT_LAYOUT, NULL);
 }
 
+static guint
+style_cache_key_hash (gconstpointer data)
+{
+  const StyleCacheKey *key = data;
+  guint hash = key->n_tags;
+  guint i;
+
+  for (i = 0; i < key->n_tags; i++)
+    hash = (hash << 5) - hash + g_direct_hash (key->tags[i]);
+
+  return hash;
+}
+
+static gboolean
+style_cache_key_equal (gconstpointer a,
+                       gconstpointer b)
+{
+  const StyleCacheKey *key_a = a;
+  const StyleCacheKey *key_b = b;
+
+  return key_a->n_tags == key_b->n_tags &&
+         memcmp (key_a->tags, key_b->tags, key_a->n_tags * sizeof (CtkTextTag *)) == 0;
+}
+
 static void
-free_style_cache (CtkTextLayout *text_layout)
+style_cache_key_free (gpointer data)
+{
+  StyleCacheKey *key = data;
+
+  g_free (key->tags);
+  g_slice_free (StyleCacheKey, key);
+}
+
+/* Drops the style of the current run only; called at tag toggles */
+static void
+free_one_style_cache (CtkTextLayout *text_layout)
 {
   if (text_layout->one_style_cache)
     {
@@ -297,6 +344,17 @@ free_style_cache (CtkTextLayout *text_layout)
     }
 }
 
+static void
+free_style_cache (CtkTextLayout *text_layout)
+{
+  CtkTextLayoutPrivate *priv = CTK_TEXT_LAYOUT_GET_PRIVATE (text_layout);
+
+  free_one_style_cache (text_layout);
+
+  if (priv->style_cache)
+    g_hash_table_remove_all (priv->style_cache);
+}
+
 /**
  * ctk_text_layout_set_buffer:
  * @buffer: (allow-none):
@@ -358,6 +416,7 @@ ctk_text_layout_default_style_changed (CtkTextLayout *layout)
   g_return_if_fail (CTK_IS_TEXT_LAYOUT (layout));
 
   DV (g_print ("invalidating all due to default style change (%s)\n", G_STRLOC));
+  free_style_cache (layout);
   ctk_text_layout_invalidate_all (layout);
 }
 
@@ -1201,7 +1260,10 @@ static CtkTextAttributes*
 get_style (CtkTextLayout *layout,
 	   GPtrArray     *tags)
 {
+  CtkTextLayoutPrivate *priv = CTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   CtkTextAttributes *style;
+  StyleCacheKey lookup_key;
+  StyleCacheKey *key;
 
   /* If we have the one-style cache, then it means
      that we haven't seen a toggle since we filled in the
@@ -1227,6 +1289,31 @@ get_style (CtkTextLayout *layout,
       return layout->default_style;
     }
 
+  /* Runs often switch back and forth between a few combinations of
+   * tags, so keep the merged attributes for each combination instead of
+   * walking the tags again for every run. The cache lives as long as
+   * the one-style cache would, i.e. for a wrap loop or a single line,
+   * during which tags and the default style cannot change.
+   */
+  lookup_key.n_tags = tags->len;
+  lookup_key.tags = (CtkTextTag **) tags->pdata;
+
+  if (priv->style_cache == NULL)
+    priv->style_cache = g_hash_table_new_full (style_cache_key_hash,
+                                               style_cache_key_equal,
+                                               style_cache_key_free,
+                                               (GDestroyNotify) ctk_text_attributes_unref);
+
+  style = g_hash_table_lookup (priv->style_cache, &lookup_key);
+  if (style != NULL)
+    {
+      ctk_text_attributes_ref (style); /* ref held by layout->one_style_cache */
+      layout->one_style_cache = style;
+
+      ctk_text_attributes_ref (style);
+      return style;
+    }
+
   style = ctk_text_attributes_new ();
 
   ctk_text_attributes_copy_values (layout->default_style,
@@ -1238,6 +1325,13 @@ get_style (CtkTextLayout *layout,
 
   g_assert (style->refcount == 1);
 
+  key = g_slice_new (StyleCacheKey);
+  key->n_tags = tags->len;
+  key->tags = g_new (CtkTextTag *, tags->len);
+  memcpy (key->tags, tags->pdata, tags->len * sizeof (CtkTextTag *));
+  ctk_text_attributes_ref (style); /* ref held by priv->style_cache */
+  g_hash_table_insert (priv->style_cache, key, style);
+
   /* Leave this style as the last one seen */
   g_assert (layout->one_style_cache == NULL);
   ctk_text_attributes_ref (style); /* ref held by layout->one_style_cache */
@@ -1297,7 +1391,7 @@ totally_invisible_line (CtkTextLayout *layout,
 
       else if (seg->type == &ctk_text_toggle_on_type)
         {
-          invalidate_cached_style (layout);
+          free_one_style_cache (layout);
 
           /* Bail out if an elision-unsetting tag begins */
           if (seg->body.toggle.info->tag->priv->invisible_set &&
@@ -1306,7 +1400,7 @@ totally_invisible_line (CtkTextLayout *layout,
         }
       else if (seg->type == &ctk_text_toggle_off_type)
         {
-          invalidate_cached_style (layout);
+          free_one_style_cache (layout);
 
           /* Bail out if an elision-setting tag ends */
           if (seg->body.toggle.info->tag->priv->invisible_set &&
@@ -2469,7 +2563,7 @@ ctk_text_layout_get_line_display (CtkTextLayout *layout,
         {
           /* Style may have changed, drop our
              current cached style */
-          invalidate_cached_style (layout);
+          free_one_style_cache (layout);
 	  /* Add the tag only after we have seen some non-toggle non-mark segment,
 	   * otherwise the tag is already accounted for by _ctk_text_btree_get_tags(). */
 	  if (!initial_toggle_segments)
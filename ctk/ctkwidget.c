@@ -51,6 +51,7 @@
 #include "ctkcontainerprivate.h"
 #include "ctkbindings.h"
 #include "ctkprivate.h"
+#include "ctkprofilerprivate.h"
 #include "ctkaccessible.h"
 #include "ctktooltipprivate.h"
 #include "ctkinvisible.h"
@@ -5991,6 +5992,7 @@ ctk_widget_size_allocate_with_baseline (CtkWidget     *widget,
   gint natural_width, natural_height, dummy;
   gint min_width, min_height;
   gint old_baseline;
+  gint64 before;
 
   g_return_if_fail (CTK_IS_WIDGET (widget));
 
@@ -6144,10 +6146,12 @@ ctk_widget_size_allocate_with_baseline (CtkWidget     *widget,
     goto out;
 
   priv->allocated_baseline = baseline;
+  before = CTK_PROFILER_CURRENT_TIME;
   if (g_signal_has_handler_pending (widget, widget_signals[SIZE_ALLOCATE], 0, FALSE))
     g_signal_emit (widget, widget_signals[SIZE_ALLOCATE], 0, &real_allocation);
   else
     CTK_WIDGET_GET_CLASS (widget)->size_allocate (widget, &real_allocation);
+  ctk_profiler_end_widget_mark (before, CTK_PROFILER_ALLOCATE, widget);
 
   /* Size allocation is god... after consulting god, no further requests or allocations are needed */
 #ifdef G_ENABLE_DEBUG
@@ -7012,6 +7016,7 @@ ctk_widget_draw_internal (CtkWidget *widget,
       CdkWindow *event_window = NULL;
       gboolean result;
       gboolean push_group;
+      gint64 before;
 
       /* If this was a cairo_t passed via ctk_widget_draw() then we don't
        * require a window; otherwise we check for the window associated
@@ -7043,6 +7048,8 @@ ctk_widget_draw_internal (CtkWidget *widget,
         g_warning ("%s %p is drawn without a current allocation. This should not happen.", G_OBJECT_TYPE_NAME (widget), widget);
 #endif
 
+      before = CTK_PROFILER_CURRENT_TIME;
+
       if (g_signal_has_handler_pending (widget, widget_signals[DRAW], 0, FALSE))
         {
           g_signal_emit (widget, widget_signals[DRAW],
@@ -7056,6 +7063,8 @@ ctk_widget_draw_internal (CtkWidget *widget,
           cairo_restore (cr);
         }
 
+      ctk_profiler_end_widget_mark (before, CTK_PROFILER_DRAW, widget);
+
 #ifdef G_ENABLE_DEBUG
       if (CTK_DISPLAY_DEBUG_CHECK (ctk_widget_get_display (widget), BASELINES))
 	{
@@ -0,0 +1,685 @@
+/*
+ * Copyright (c) 2026 the CTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib/gi18n-lib.h>
+
+#include "frames.h"
+
+#include "ctkprofilerprivate.h"
+
+#include "ctklabel.h"
+#include "ctkliststore.h"
+#include "ctkpango.h"
+#include "ctkswitch.h"
+#include "ctktreeview.h"
+#include "ctkcelllayout.h"
+
+/* How often the numbers are refreshed, in milliseconds */
+#define UPDATE_INTERVAL 500
+
+/* The number of widgets shown in the list */
+#define TOP_WIDGETS 50
+
+/* Self time at which a redrawn area is shown fully red, in µs */
+#define HEAT_MAX 2000
+
+#define HUD_MARGIN 8
+#define HUD_PADDING 6
+
+enum
+{
+  COLUMN_NAME,
+  COLUMN_MEASURE,
+  COLUMN_ALLOCATE,
+  COLUMN_DRAW,
+  COLUMN_TOTAL
+};
+
+struct _CtkInspectorFramesPrivate
+{
+  CtkWidget *fps;
+  CtkWidget *layout;
+  CtkWidget *paint;
+  CtkWidget *present;
+  CtkWidget *longest;
+  CtkWidget *styles;
+  CtkWidget *overlay_switch;
+  CtkListStore *model;
+  CtkTreeViewColumn *column_measure;
+  CtkCellRenderer *renderer_measure;
+  CtkTreeViewColumn *column_allocate;
+  CtkCellRenderer *renderer_allocate;
+  CtkTreeViewColumn *column_draw;
+  CtkCellRenderer *renderer_draw;
+  CtkTreeViewColumn *column_total;
+  CtkCellRenderer *renderer_total;
+
+  CtkWidget *toplevel;
+  CdkFrameClock *clock;
+  gboolean collecting;
+  gboolean overlay;
+  guint update_source_id;
+  gchar *hud_text;
+  CdkRectangle hud_area;
+
+  /* Phase boundaries of the current frame */
+  gint64 frame_start;
+  gint64 update_end;
+  gint64 layout_end;
+  gint64 paint_end;
+
+  /* Totals since the last update */
+  gint64 last_update;
+  gint64 last_presented;
+  guint n_frames;
+  gint64 layout_time;
+  gint64 paint_time;
+  gint64 longest_frame;
+  guint n_presented;
+  gint64 present_time;
+  guint styles_computed;
+  guint styles_cached;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (CtkInspectorFrames, ctk_inspector_frames, CTK_TYPE_BOX)
+
+static void
+before_paint (CdkFrameClock      *clock,
+              CtkInspectorFrames *sl)
+{
+  sl->priv->frame_start = g_get_monotonic_time ();
+  sl->priv->update_end = 0;
+  sl->priv->layout_end = 0;
+  sl->priv->paint_end = 0;
+}
+
+static void
+update_done (CdkFrameClock      *clock,
+             CtkInspectorFrames *sl)
+{
+  sl->priv->update_end = g_get_monotonic_time ();
+}
+
+static void
+layout_done (CdkFrameClock      *clock,
+             CtkInspectorFrames *sl)
+{
+  sl->priv->layout_end = g_get_monotonic_time ();
+}
+
+static void
+paint_done (CdkFrameClock      *clock,
+            CtkInspectorFrames *sl)
+{
+  sl->priv->paint_end = g_get_monotonic_time ();
+}
+
+/* Looks for the latest frame that the compositor reported as
+ * presented, which is usually a frame or two behind the current one.
+ */
+static void
+add_presentation_time (CtkInspectorFrames *sl,
+                       CdkFrameClock      *clock)
+{
+  gint64 frame, history_start;
+
+  history_start = cdk_frame_clock_get_history_start (clock);
+
+  for (frame = cdk_frame_clock_get_frame_counter (clock);
+       frame >= history_start && frame > sl->priv->last_presented;
+       frame--)
+    {
+      CdkFrameTimings *timings;
+      gint64 presentation_time;
+
+      timings = cdk_frame_clock_get_timings (clock, frame);
+      if (timings == NULL || !cdk_frame_timings_get_complete (timings))
+        continue;
+
+      presentation_time = cdk_frame_timings_get_presentation_time (timings);
+      if (presentation_time == 0)
+        continue;
+
+      sl->priv->present_time += presentation_time - cdk_frame_timings_get_frame_time (timings);
+      sl->priv->n_presented++;
+      sl->priv->last_presented = frame;
+      break;
+    }
+}
+
+static void
+after_paint (CdkFrameClock      *clock,
+             CtkInspectorFrames *sl)
+{
+  CtkInspectorFramesPrivate *priv = sl->priv;
+  gint64 layout_start, paint_start;
+  guint computed, cached;
+
+  /* The update and layout phases are skipped when nothing asked for
+   * them, so fall back to the previous boundary.
+   */
+  layout_start = priv->update_end ? priv->update_end : priv->frame_start;
+  paint_start = priv->layout_end ? priv->layout_end : layout_start;
+
+  priv->layout_time += paint_start - layout_start;
+  if (priv->paint_end)
+    priv->paint_time += priv->paint_end - paint_start;
+  priv->longest_frame = MAX (priv->longest_frame, g_get_monotonic_time () - priv->frame_start);
+  priv->n_frames++;
+
+  add_presentation_time (sl, clock);
+
+  ctk_profiler_get_style_counts (&computed, &cached);
+  priv->styles_computed += computed;
+  priv->styles_cached += cached;
+
+  ctk_profiler_reset_frame ();
+}
+
+static gint
+compare_costs (gconstpointer a,
+               gconstpointer b)
+{
+  const CtkProfilerWidgetCost *cost_a = *(const CtkProfilerWidgetCost **) a;
+  const CtkProfilerWidgetCost *cost_b = *(const CtkProfilerWidgetCost **) b;
+  gint64 total_a, total_b;
+  gint i;
+
+  total_a = total_b = 0;
+  for (i = 0; i < CTK_PROFILER_N_PHASES; i++)
+    {
+      total_a += cost_a->time[i];
+      total_b += cost_b->time[i];
+    }
+
+  return (total_a < total_b) - (total_a > total_b);
+}
+
+static void
+update_widgets (CtkInspectorFrames *sl)
+{
+  GHashTableIter iter;
+  GPtrArray *costs;
+  gpointer value;
+  guint i;
+
+  costs = g_ptr_array_new ();
+
+  g_hash_table_iter_init (&iter, ctk_profiler_get_widget_costs ());
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      CtkProfilerWidgetCost *cost = value;
+
+      if (cost->toplevel == (gpointer) sl->priv->toplevel)
+        g_ptr_array_add (costs, cost);
+    }
+
+  g_ptr_array_sort (costs, compare_costs);
+
+  ctk_list_store_clear (sl->priv->model);
+
+  for (i = 0; i < MIN (costs->len, TOP_WIDGETS); i++)
+    {
+      CtkProfilerWidgetCost *cost = g_ptr_array_index (costs, i);
+      gchar *name;
+
+      name = g_strdup_printf ("%s %p", g_type_name (cost->type), cost->widget);
+      ctk_list_store_insert_with_values (sl->priv->model, NULL, -1,
+                                         COLUMN_NAME, name,
+                                         COLUMN_MEASURE, cost->time[CTK_PROFILER_MEASURE],
+                                         COLUMN_ALLOCATE, cost->time[CTK_PROFILER_ALLOCATE],
+                                         COLUMN_DRAW, cost->time[CTK_PROFILER_DRAW],
+                                         COLUMN_TOTAL, cost->time[CTK_PROFILER_MEASURE] +
+                                                       cost->time[CTK_PROFILER_ALLOCATE] +
+                                                       cost->time[CTK_PROFILER_DRAW],
+                                         -1);
+      g_free (name);
+    }
+
+  g_ptr_array_unref (costs);
+
+  ctk_profiler_reset_widget_costs ();
+}
+
+static void
+set_label (CtkWidget   *label,
+           const gchar *format,
+           ...) G_GNUC_PRINTF (2, 3);
+
+static void
+set_label (CtkWidget   *label,
+           const gchar *format,
+           ...)
+{
+  va_list args;
+  gchar *text;
+
+  va_start (args, format);
+  text = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  ctk_label_set_label (CTK_LABEL (label), text);
+  g_free (text);
+}
+
+static gboolean
+update_stats (gpointer data)
+{
+  CtkInspectorFrames *sl = data;
+  CtkInspectorFramesPrivate *priv = sl->priv;
+  gint64 now;
+  gdouble fps, layout, paint, present, longest, computed, cached;
+
+  now = g_get_monotonic_time ();
+
+  fps = priv->n_frames * (gdouble) G_USEC_PER_SEC / MAX (now - priv->last_update, 1);
+  layout = priv->n_frames ? priv->layout_time / (1000.0 * priv->n_frames) : 0;
+  paint = priv->n_frames ? priv->paint_time / (1000.0 * priv->n_frames) : 0;
+  present = priv->n_presented ? priv->present_time / (1000.0 * priv->n_presented) : 0;
+  longest = priv->longest_frame / 1000.0;
+  computed = priv->n_frames ? priv->styles_computed / (gdouble) priv->n_frames : 0;
+  cached = priv->n_frames ? priv->styles_cached / (gdouble) priv->n_frames : 0;
+
+  set_label (priv->fps, "%4.1f ⁄ s", fps);
+  set_label (priv->layout, "%.2f ms", layout);
+  set_label (priv->paint, "%.2f ms", paint);
+  if (priv->n_presented)
+    set_label (priv->present, "%.2f ms", present);
+  else
+    ctk_label_set_label (CTK_LABEL (priv->present), "—");
+  set_label (priv->longest, "%.2f ms", longest);
+  set_label (priv->styles, _("%.1f computed, %.1f cached"), computed, cached);
+
+  if (ctk_widget_get_mapped (CTK_WIDGET (sl)))
+    update_widgets (sl);
+  else
+    ctk_profiler_reset_widget_costs ();
+
+  if (priv->overlay)
+    {
+      g_free (priv->hud_text);
+      priv->hud_text = g_strdup_printf (_("%4.1f frames ⁄ s\n"
+                                          "Layout %.2f ms, paint %.2f ms\n"
+                                          "Presented after %.2f ms\n"
+                                          "Longest frame %.2f ms\n"
+                                          "Restyles %.1f computed, %.1f cached"),
+                                        fps, layout, paint, present, longest,
+                                        computed, cached);
+
+      /* Only the HUD needs to change; queueing a full redraw here would
+       * keep the window busy and skew the numbers.
+       */
+      if (priv->hud_area.width > 0)
+        ctk_widget_queue_draw_area (priv->toplevel,
+                                    priv->hud_area.x, priv->hud_area.y,
+                                    priv->hud_area.width, priv->hud_area.height);
+      else
+        ctk_widget_queue_draw (priv->toplevel);
+    }
+
+  priv->last_update = now;
+  priv->n_frames = 0;
+  priv->layout_time = 0;
+  priv->paint_time = 0;
+  priv->longest_frame = 0;
+  priv->n_presented = 0;
+  priv->present_time = 0;
+  priv->styles_computed = 0;
+  priv->styles_cached = 0;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+draw_heatmap (CtkInspectorFrames *sl,
+              CtkWidget          *widget,
+              cairo_t            *cr)
+{
+  GArray *redraws;
+  guint i;
+
+  redraws = ctk_profiler_get_redraws ();
+
+  for (i = 0; i < redraws->len; i++)
+    {
+      const CtkProfilerRedraw *redraw = &g_array_index (redraws, CtkProfilerRedraw, i);
+      gdouble heat;
+
+      if (redraw->toplevel != widget)
+        continue;
+
+      heat = MIN (redraw->time, HEAT_MAX) / (gdouble) HEAT_MAX;
+      cairo_set_source_rgba (cr, heat, 1 - heat, 0, 0.1 + 0.4 * heat);
+      cdk_cairo_rectangle (cr, &redraw->area);
+      cairo_fill (cr);
+    }
+}
+
+static void
+draw_hud (CtkInspectorFrames *sl,
+          CtkWidget          *widget,
+          cairo_t            *cr)
+{
+  CtkInspectorFramesPrivate *priv = sl->priv;
+  PangoLayout *layout;
+  gint width, height;
+
+  layout = ctk_widget_create_pango_layout (widget, priv->hud_text ? priv->hud_text : "");
+  pango_layout_get_pixel_size (layout, &width, &height);
+
+  priv->hud_area.x = HUD_MARGIN;
+  priv->hud_area.y = HUD_MARGIN;
+  priv->hud_area.width = width + 2 * HUD_PADDING;
+  priv->hud_area.height = height + 2 * HUD_PADDING;
+
+  cairo_set_source_rgba (cr, 0, 0, 0, 0.7);
+  cdk_cairo_rectangle (cr, &priv->hud_area);
+  cairo_fill (cr);
+
+  cairo_set_source_rgb (cr, 1, 1, 1);
+  cairo_move_to (cr, HUD_MARGIN + HUD_PADDING, HUD_MARGIN + HUD_PADDING);
+  pango_cairo_show_layout (cr, layout);
+
+  g_object_unref (layout);
+}
+
+static gboolean
+draw_overlay (CtkWidget          *widget,
+              cairo_t            *cr,
+              CtkInspectorFrames *sl)
+{
+  cairo_save (cr);
+  draw_heatmap (sl, widget, cr);
+  draw_hud (sl, widget, cr);
+  cairo_restore (cr);
+
+  return FALSE;
+}
+
+static void
+connect_overlay (CtkInspectorFrames *sl)
+{
+  if (sl->priv->toplevel == NULL)
+    return;
+
+  sl->priv->hud_area.width = 0;
+  g_signal_connect_after (sl->priv->toplevel, "draw", G_CALLBACK (draw_overlay), sl);
+  ctk_widget_queue_draw (sl->priv->toplevel);
+}
+
+static void
+disconnect_overlay (CtkInspectorFrames *sl)
+{
+  if (sl->priv->toplevel == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_func (sl->priv->toplevel, draw_overlay, sl);
+  ctk_widget_queue_draw (sl->priv->toplevel);
+}
+
+static void
+start_collecting (CtkInspectorFrames *sl,
+                  CdkFrameClock      *clock)
+{
+  CtkInspectorFramesPrivate *priv = sl->priv;
+
+  ctk_profiler_start_collecting ();
+
+  priv->collecting = TRUE;
+  priv->clock = g_object_ref (clock);
+  g_signal_connect (priv->clock, "before-paint", G_CALLBACK (before_paint), sl);
+  g_signal_connect_after (priv->clock, "update", G_CALLBACK (update_done), sl);
+  g_signal_connect_after (priv->clock, "layout", G_CALLBACK (layout_done), sl);
+  g_signal_connect_after (priv->clock, "paint", G_CALLBACK (paint_done), sl);
+  g_signal_connect_after (priv->clock, "after-paint", G_CALLBACK (after_paint), sl);
+
+  priv->last_update = g_get_monotonic_time ();
+  priv->last_presented = cdk_frame_clock_get_frame_counter (priv->clock);
+  priv->update_source_id = cdk_threads_add_timeout (UPDATE_INTERVAL, update_stats, sl);
+}
+
+static void
+stop_collecting (CtkInspectorFrames *sl)
+{
+  CtkInspectorFramesPrivate *priv = sl->priv;
+
+  g_source_remove (priv->update_source_id);
+  priv->update_source_id = 0;
+
+  g_signal_handlers_disconnect_by_data (priv->clock, sl);
+  g_clear_object (&priv->clock);
+  priv->collecting = FALSE;
+
+  ctk_profiler_stop_collecting ();
+}
+
+/* Collection is only enabled while the numbers are looked at, either
+ * on this page or in the overlay, since it slows down every widget.
+ * The toplevel only has a frame clock while it is realized, and gets
+ * a new one when it is realized again.
+ */
+static void
+update_collecting (CtkInspectorFrames *sl)
+{
+  CtkInspectorFramesPrivate *priv = sl->priv;
+  CdkFrameClock *clock;
+  gboolean collect;
+
+  clock = priv->toplevel ? ctk_widget_get_frame_clock (priv->toplevel) : NULL;
+  collect = clock != NULL &&
+            (priv->overlay || ctk_widget_get_mapped (CTK_WIDGET (sl)));
+
+  if (priv->collecting && (!collect || clock != priv->clock))
+    stop_collecting (sl);
+
+  if (collect && !priv->collecting)
+    start_collecting (sl, clock);
+}
+
+static void
+toplevel_realize_changed (CtkWidget          *toplevel,
+                          CtkInspectorFrames *sl)
+{
+  update_collecting (sl);
+}
+
+static void
+overlay_switch_changed (CtkSwitch          *sw,
+                        GParamSpec         *pspec,
+                        CtkInspectorFrames *sl)
+{
+  gboolean overlay;
+
+  overlay = ctk_switch_get_active (sw);
+  if (overlay == sl->priv->overlay)
+    return;
+
+  sl->priv->overlay = overlay;
+
+  if (overlay)
+    connect_overlay (sl);
+  else
+    disconnect_overlay (sl);
+
+  update_collecting (sl);
+}
+
+static void
+set_toplevel (CtkInspectorFrames *sl,
+              CtkWidget          *toplevel)
+{
+  CtkInspectorFramesPrivate *priv = sl->priv;
+
+  if (priv->toplevel == toplevel)
+    return;
+
+  if (priv->toplevel)
+    {
+      if (priv->overlay)
+        disconnect_overlay (sl);
+      g_signal_handlers_disconnect_by_func (priv->toplevel, toplevel_realize_changed, sl);
+      g_clear_object (&priv->toplevel);
+      update_collecting (sl);
+    }
+
+  if (toplevel)
+    {
+      priv->toplevel = g_object_ref (toplevel);
+      g_signal_connect_after (toplevel, "realize", G_CALLBACK (toplevel_realize_changed), sl);
+      g_signal_connect_after (toplevel, "unrealize", G_CALLBACK (toplevel_realize_changed), sl);
+      if (priv->overlay)
+        connect_overlay (sl);
+      update_collecting (sl);
+    }
+}
+
+void
+ctk_inspector_frames_set_object (CtkInspectorFrames *sl,
+                                 GObject            *object)
+{
+  CtkWidget *toplevel;
+
+  if (!CTK_IS_WIDGET (object))
+    {
+      ctk_widget_hide (CTK_WIDGET (sl));
+      set_toplevel (sl, NULL);
+      return;
+    }
+
+  ctk_widget_show (CTK_WIDGET (sl));
+
+  toplevel = ctk_widget_get_toplevel (CTK_WIDGET (object));
+  set_toplevel (sl, ctk_widget_is_toplevel (toplevel) ? toplevel : NULL);
+}
+
+static void
+cell_data_time (CtkCellLayout   *layout,
+                CtkCellRenderer *cell,
+                CtkTreeModel    *model,
+                CtkTreeIter     *iter,
+                gpointer         data)
+{
+  gint column;
+  gint64 time;
+  gchar *text;
+
+  column = GPOINTER_TO_INT (data);
+
+  ctk_tree_model_get (model, iter, column, &time, -1);
+
+  text = g_strdup_printf ("%.2f ms", time / 1000.0);
+  g_object_set (cell, "text", text, NULL);
+  g_free (text);
+}
+
+static void
+ctk_inspector_frames_init (CtkInspectorFrames *sl)
+{
+  sl->priv = ctk_inspector_frames_get_instance_private (sl);
+  ctk_widget_init_template (CTK_WIDGET (sl));
+
+  ctk_cell_layout_set_cell_data_func (CTK_CELL_LAYOUT (sl->priv->column_measure),
+                                      sl->priv->renderer_measure,
+                                      cell_data_time,
+                                      GINT_TO_POINTER (COLUMN_MEASURE), NULL);
+  ctk_cell_layout_set_cell_data_func (CTK_CELL_LAYOUT (sl->priv->column_allocate),
+                                      sl->priv->renderer_allocate,
+                                      cell_data_time,
+                                      GINT_TO_POINTER (COLUMN_ALLOCATE), NULL);
+  ctk_cell_layout_set_cell_data_func (CTK_CELL_LAYOUT (sl->priv->column_draw),
+                                      sl->priv->renderer_draw,
+                                      cell_data_time,
+                                      GINT_TO_POINTER (COLUMN_DRAW), NULL);
+  ctk_cell_layout_set_cell_data_func (CTK_CELL_LAYOUT (sl->priv->column_total),
+                                      sl->priv->renderer_total,
+                                      cell_data_time,
+                                      GINT_TO_POINTER (COLUMN_TOTAL), NULL);
+
+  ctk_tree_sortable_set_sort_column_id (CTK_TREE_SORTABLE (sl->priv->model),
+                                        COLUMN_TOTAL, CTK_SORT_DESCENDING);
+}
+
+static void
+map (CtkWidget *widget)
+{
+  CTK_WIDGET_CLASS (ctk_inspector_frames_parent_class)->map (widget);
+
+  update_collecting (CTK_INSPECTOR_FRAMES (widget));
+}
+
+static void
+unmap (CtkWidget *widget)
+{
+  CTK_WIDGET_CLASS (ctk_inspector_frames_parent_class)->unmap (widget);
+
+  update_collecting (CTK_INSPECTOR_FRAMES (widget));
+}
+
+static void
+dispose (GObject *object)
+{
+  CtkInspectorFrames *sl = CTK_INSPECTOR_FRAMES (object);
+
+  set_toplevel (sl, NULL);
+
+  G_OBJECT_CLASS (ctk_inspector_frames_parent_class)->dispose (object);
+}
+
+static void
+finalize (GObject *object)
+{
+  CtkInspectorFrames *sl = CTK_INSPECTOR_FRAMES (object);
+
+  g_free (sl->priv->hud_text);
+
+  G_OBJECT_CLASS (ctk_inspector_frames_parent_class)->finalize (object);
+}
+
+static void
+ctk_inspector_frames_class_init (CtkInspectorFramesClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  CtkWidgetClass *widget_class = CTK_WIDGET_CLASS (klass);
+
+  object_class->dispose = dispose;
+  object_class->finalize = finalize;
+
+  widget_class->map = map;
+  widget_class->unmap = unmap;
+
+  ctk_widget_class_set_template_from_resource (widget_class, "/org/ctk/libctk/inspector/frames.ui");
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, fps);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, layout);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, paint);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, present);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, longest);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, styles);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, overlay_switch);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, model);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, column_measure);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, renderer_measure);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, column_allocate);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, renderer_allocate);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, column_draw);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, renderer_draw);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, column_total);
+  ctk_widget_class_bind_template_child_private (widget_class, CtkInspectorFrames, renderer_total);
+  ctk_widget_class_bind_template_callback (widget_class, overlay_switch_changed);
+}
+
+// vim: set et sw=2 ts=2:
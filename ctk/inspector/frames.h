@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026 the CTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CTK_INSPECTOR_FRAMES_H_
+#define _CTK_INSPECTOR_FRAMES_H_
+
+#include <ctk/ctkbox.h>
+
+#define CTK_TYPE_INSPECTOR_FRAMES            (ctk_inspector_frames_get_type())
+#define CTK_INSPECTOR_FRAMES(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), CTK_TYPE_INSPECTOR_FRAMES, CtkInspectorFrames))
+#define CTK_INSPECTOR_FRAMES_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), CTK_TYPE_INSPECTOR_FRAMES, CtkInspectorFramesClass))
+#define CTK_INSPECTOR_IS_FRAMES(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj), CTK_TYPE_INSPECTOR_FRAMES))
+#define CTK_INSPECTOR_IS_FRAMES_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), CTK_TYPE_INSPECTOR_FRAMES))
+#define CTK_INSPECTOR_FRAMES_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), CTK_TYPE_INSPECTOR_FRAMES, CtkInspectorFramesClass))
+
+
+typedef struct _CtkInspectorFramesPrivate CtkInspectorFramesPrivate;
+
+typedef struct _CtkInspectorFrames
+{
+  CtkBox parent;
+  CtkInspectorFramesPrivate *priv;
+} CtkInspectorFrames;
+
+typedef struct _CtkInspectorFramesClass
+{
+  CtkBoxClass parent;
+} CtkInspectorFramesClass;
+
+G_BEGIN_DECLS
+
+GType      ctk_inspector_frames_get_type   (void);
+void       ctk_inspector_frames_set_object (CtkInspectorFrames *sl,
+                                            GObject            *object);
+
+G_END_DECLS
+
+#endif // _CTK_INSPECTOR_FRAMES_H_
+
+// vim: set et sw=2 ts=2:
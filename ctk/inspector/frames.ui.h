@@ -0,0 +1,13 @@
+N_("Frame rate");
+N_("Layout");
+N_("Paint");
+N_("Presentation");
+N_("Longest frame");
+N_("Restyles per frame");
+N_("Show frame times and the cost of redrawn areas on the window");
+N_("Overlay");
+N_("Widget");
+N_("Measure");
+N_("Allocate");
+N_("Draw");
+N_("Total");
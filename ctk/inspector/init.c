@@ -29,6 +29,7 @@
 #include "css-editor.h"
 #include "css-node-tree.h"
 #include "data-list.h"
+#include "frames.h"
 #include "general.h"
 #include "gestures.h"
 #include "graphdata.h"
@@ -62,6 +63,7 @@ ctk_inspector_init (void)
   g_type_ensure (CTK_TYPE_INSPECTOR_CSS_EDITOR);
   g_type_ensure (CTK_TYPE_INSPECTOR_CSS_NODE_TREE);
   g_type_ensure (CTK_TYPE_INSPECTOR_DATA_LIST);
+  g_type_ensure (CTK_TYPE_INSPECTOR_FRAMES);
   g_type_ensure (CTK_TYPE_INSPECTOR_GENERAL);
   g_type_ensure (CTK_TYPE_INSPECTOR_GESTURES);
   g_type_ensure (CTK_TYPE_MAGNIFIER);
@@ -36,6 +36,7 @@
 #include "selector.h"
 #include "size-groups.h"
 #include "data-list.h"
+#include "frames.h"
 #include "signals-list.h"
 #include "actions.h"
 #include "menu.h"
@@ -78,6 +79,7 @@ set_selected_object (CtkInspectorWindow *iw,
   ctk_inspector_menu_set_object (CTK_INSPECTOR_MENU (iw->menu), selected);
   ctk_inspector_gestures_set_object (CTK_INSPECTOR_GESTURES (iw->gestures), selected);
   ctk_inspector_magnifier_set_object (CTK_INSPECTOR_MAGNIFIER (iw->magnifier), selected);
+  ctk_inspector_frames_set_object (CTK_INSPECTOR_FRAMES (iw->frames), selected);
 
   for (l = iw->extra_pages; l != NULL; l = l->next)
     g_object_set (l->data, "object", selected, NULL);
@@ -273,6 +275,7 @@ ctk_inspector_window_class_init (CtkInspectorWindowClass *klass)
   ctk_widget_class_bind_template_child (widget_class, CtkInspectorWindow, misc_info);
   ctk_widget_class_bind_template_child (widget_class, CtkInspectorWindow, gestures);
   ctk_widget_class_bind_template_child (widget_class, CtkInspectorWindow, magnifier);
+  ctk_widget_class_bind_template_child (widget_class, CtkInspectorWindow, frames);
 
   ctk_widget_class_bind_template_callback (widget_class, ctk_inspector_on_inspect);
   ctk_widget_class_bind_template_callback (widget_class, on_object_activated);
@@ -68,6 +68,7 @@ typedef struct
   CtkWidget *misc_info;
   CtkWidget *gestures;
   CtkWidget *magnifier;
+  CtkWidget *frames;
 
   CtkWidget *invisible;
   CtkWidget *selected_widget;
@@ -16,6 +16,7 @@
  */
 
 #include <ctk/ctk.h>
+#include <string.h>
 
 static gint serial = 0;
 
@@ -306,6 +307,37 @@ test_delete (void)
   g_object_unref (entry);
 }
 
+static void
+test_buffer_offsets (void)
+{
+  CtkEntryBuffer *buffer;
+
+  buffer = ctk_entry_buffer_new ("äöü", -1);
+
+  /* Edits around a previous edit, from both directions */
+  ctk_entry_buffer_insert_text (buffer, 3, "xyz", -1);
+  g_assert_cmpstr (ctk_entry_buffer_get_text (buffer), ==, "äöüxyz");
+  ctk_entry_buffer_insert_text (buffer, 1, "€", -1);
+  g_assert_cmpstr (ctk_entry_buffer_get_text (buffer), ==, "ä€öüxyz");
+  ctk_entry_buffer_insert_text (buffer, 5, "ß", -1);
+  g_assert_cmpstr (ctk_entry_buffer_get_text (buffer), ==, "ä€öüxßyz");
+  ctk_entry_buffer_delete_text (buffer, 2, 2);
+  g_assert_cmpstr (ctk_entry_buffer_get_text (buffer), ==, "ä€xßyz");
+  ctk_entry_buffer_delete_text (buffer, 0, 1);
+  g_assert_cmpstr (ctk_entry_buffer_get_text (buffer), ==, "€xßyz");
+  ctk_entry_buffer_insert_text (buffer, 4, "ö", -1);
+  g_assert_cmpstr (ctk_entry_buffer_get_text (buffer), ==, "€xßyöz");
+  ctk_entry_buffer_delete_text (buffer, 3, -1);
+  g_assert_cmpstr (ctk_entry_buffer_get_text (buffer), ==, "€xß");
+  ctk_entry_buffer_insert_text (buffer, 2, "ü", -1);
+  g_assert_cmpstr (ctk_entry_buffer_get_text (buffer), ==, "€xüß");
+
+  g_assert_cmpuint (ctk_entry_buffer_get_length (buffer), ==, 4);
+  g_assert_cmpuint (ctk_entry_buffer_get_bytes (buffer), ==, strlen ("€xüß"));
+
+  g_object_unref (buffer);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -314,6 +346,7 @@ main (int   argc,
 
   g_test_add_func ("/entry/delete", test_delete);
   g_test_add_func ("/entry/insert", test_insert);
+  g_test_add_func ("/entry/buffer-offsets", test_buffer_offsets);
 
   return g_test_run();
 }
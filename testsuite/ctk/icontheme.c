@@ -787,6 +787,40 @@ test_nonsquare_symbolic (void)
   g_object_unref (info);
 }
 
+static void
+test_lookup_icons (void)
+{
+  const gchar *names[] = { "one-two-three", "this-icon-totally-does-not-exist", NULL, "one-two-symbolic" };
+  CtkIconInfo **infos;
+  CtkIconInfo *info;
+  gint i;
+
+  infos = ctk_icon_theme_lookup_icons (get_test_icontheme (FALSE),
+                                       names, G_N_ELEMENTS (names),
+                                       SCALABLE_IMAGE_SIZE, 1,
+                                       CTK_ICON_LOOKUP_GENERIC_FALLBACK);
+
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    {
+      if (names[i] != NULL)
+        info = ctk_icon_theme_lookup_icon (get_test_icontheme (FALSE),
+                                           names[i], SCALABLE_IMAGE_SIZE,
+                                           CTK_ICON_LOOKUP_GENERIC_FALLBACK);
+      else
+        info = NULL;
+
+      if (info == NULL)
+        g_assert (infos[i] == NULL);
+      else
+        g_assert_cmpstr (ctk_icon_info_get_filename (infos[i]), ==, ctk_icon_info_get_filename (info));
+
+      g_clear_object (&info);
+      g_clear_object (&infos[i]);
+    }
+
+  g_free (infos);
+}
+
 static GLogWriterOutput
 log_writer_drop_warnings (GLogLevelFlags   log_level,
                           const GLogField *fields,
@@ -828,6 +862,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/icontheme/inherit", test_inherit);
   g_test_add_func ("/icontheme/nonsquare-symbolic", test_nonsquare_symbolic);
   g_test_add_func ("/icontheme/lookup-order", test_lookup_order);
+  g_test_add_func ("/icontheme/lookup-icons", test_lookup_icons);
 
   return g_test_run();
 }
@@ -1325,6 +1325,84 @@ test_fill_empty (void)
   g_object_unref (buffer);
 }
 
+static gboolean
+collect_chunk (const gchar *text,
+               gsize        len,
+               gpointer     user_data)
+{
+  g_string_append_len (user_data, text, len);
+
+  return TRUE;
+}
+
+static gboolean
+stop_after_first_chunk (const gchar *text,
+                        gsize        len,
+                        gpointer     user_data)
+{
+  gint *count = user_data;
+
+  (*count)++;
+
+  return FALSE;
+}
+
+static void
+test_chunks (void)
+{
+  CtkTextBuffer *buffer;
+  CtkTextIter start, end;
+  CtkTextTag *tag;
+  GString *str;
+  GBytes *bytes;
+  gchar *text;
+  gint count;
+
+  buffer = ctk_text_buffer_new (NULL);
+  fill_buffer (buffer);
+
+  tag = ctk_text_buffer_create_tag (buffer, NULL, "invisible", TRUE, NULL);
+  ctk_text_buffer_get_iter_at_offset (buffer, &start, 5);
+  ctk_text_buffer_get_iter_at_offset (buffer, &end, 25);
+  ctk_text_buffer_apply_tag (buffer, tag, &start, &end);
+
+  ctk_text_buffer_get_bounds (buffer, &start, &end);
+
+  str = g_string_new (NULL);
+  g_assert_true (ctk_text_buffer_foreach_chunk (buffer, &start, &end, TRUE,
+                                                collect_chunk, str));
+  text = ctk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (str->str, ==, text);
+  bytes = ctk_text_buffer_get_bytes (buffer, &start, &end, TRUE);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes),
+                   text, strlen (text));
+  g_bytes_unref (bytes);
+  g_free (text);
+
+  g_string_truncate (str, 0);
+  g_assert_true (ctk_text_buffer_foreach_chunk (buffer, &start, &end, FALSE,
+                                                collect_chunk, str));
+  text = ctk_text_buffer_get_text (buffer, &start, &end, FALSE);
+  g_assert_cmpstr (str->str, ==, text);
+  bytes = ctk_text_buffer_get_bytes (buffer, &start, &end, FALSE);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes),
+                   text, strlen (text));
+  g_bytes_unref (bytes);
+  g_free (text);
+
+  count = 0;
+  g_assert_false (ctk_text_buffer_foreach_chunk (buffer, &start, &end, TRUE,
+                                                 stop_after_first_chunk, &count));
+  g_assert_cmpint (count, ==, 1);
+
+  bytes = ctk_text_buffer_get_bytes (buffer, &start, &start, TRUE);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 0);
+  g_bytes_unref (bytes);
+
+  g_string_free (str, TRUE);
+  g_object_unref (buffer);
+}
+
 static void
 test_tag (void)
 {
@@ -1572,6 +1650,7 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Empty buffer", test_empty_buffer);
   g_test_add_func ("/TextBuffer/Get and Set", test_get_set);
   g_test_add_func ("/TextBuffer/Fill and Empty", test_fill_empty);
+  g_test_add_func ("/TextBuffer/Chunks", test_chunks);
   g_test_add_func ("/TextBuffer/Tag", test_tag);
   g_test_add_func ("/TextBuffer/Clipboard", test_clipboard);
   g_test_add_func ("/TextBuffer/Get iter", test_get_iter);